@@ -0,0 +1,195 @@
+//
+//  AssetLoader.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 30/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "AssetLoader.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "ObjectLoader.hpp"
+#include "ShaderLoader.hpp"
+
+using namespace std;
+
+/**
+ *  How many parsed assets can wait for upload before
+ *  the loader threads hold off.
+ */
+#define asset_queue_size 256
+
+AssetLoader::AssetLoader(int thread_count) : stopping(false), finished(asset_queue_size), parsed(0) {
+#if defined(OPENGL_SINGLE_THREADED)
+    thread_count = 0;
+#endif
+    
+    for(int i = 0; i < thread_count; i++) {
+        threads.push_back(thread(&AssetLoader::worker, this));
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        lock_guard<mutex> guard(requests_lock);
+        stopping = true;
+        requests.clear();
+    }
+    requests_ready.notify_all();
+    
+    for(auto &t: threads) {
+        t.join();
+    }
+}
+
+AssetId AssetLoader::load(const string &path, AssetType type, const AssetUpload &upload) {
+    AssetId id = next_id++;
+    uploads.push_back(upload);
+    
+    {
+        lock_guard<mutex> guard(requests_lock);
+        requests.push_back({id, type, path});
+    }
+    requests_ready.notify_one();
+    
+    return id;
+}
+
+unique_ptr<AssetData> AssetLoader::parse(const AssetRequest &request) const {
+    unique_ptr<AssetData> data(new AssetData());
+    data->id = request.id;
+    data->type = request.type;
+    data->path = request.path;
+    data->loaded = false;
+    
+    ifstream file(request.path, ios::in | ios::binary);
+    if(!file.is_open()) {
+        cerr << "Asset not found: " << request.path << endl;
+        return data;
+    }
+    
+    switch(request.type) {
+        case ASSET_MODEL: {
+            file.close();
+            ObjectLoader loader;
+            loader.load(request.path.c_str());
+            data->vertices = loader.getVertices();
+            break;
+        }
+        case ASSET_TEXT: {
+            file.close();
+            data->text = ShaderLoader::load(request.path.c_str());
+            break;
+        }
+        case ASSET_BINARY: {
+            data->bytes.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+            break;
+        }
+    }
+    
+    data->loaded = true;
+    return data;
+}
+
+/**
+ *  Waits for room if the render thread has fallen behind,
+ *  rather than letting parsed assets pile up without end.
+ *  Gives up once the loader is stopping, as nothing will
+ *  take from the queue again.
+ */
+void AssetLoader::hand(unique_ptr<AssetData> data) {
+    parsed.fetch_add(1, memory_order_relaxed);
+    while(!finished.push(data)) {
+        if(stopping.load(memory_order_relaxed)) {
+            return;
+        }
+        this_thread::yield();
+    }
+}
+
+void AssetLoader::worker(void) {
+    for(;;) {
+        AssetRequest request;
+        {
+            unique_lock<mutex> guard(requests_lock);
+            requests_ready.wait(guard, [this] {
+                return stopping || !requests.empty();
+            });
+            if(stopping) {
+                return;
+            }
+            request = requests.front();
+            requests.pop_front();
+        }
+        
+        hand(parse(request));
+    }
+}
+
+int AssetLoader::update(double budget_ms) {
+    typedef chrono::steady_clock clock;
+    const clock::time_point start = clock::now();
+    auto spent = [start]() {
+        return chrono::duration<double, milli>(clock::now() - start).count();
+    };
+    
+    int count = 0;
+    
+    for(;;) {
+        if(count > 0 && spent() >= budget_ms) {
+            break;
+        }
+        
+        unique_ptr<AssetData> data;
+        if(!finished.pop(data)) {
+            /**
+             *  With no loader threads the reading
+             *  happens here, one asset at a time.
+             */
+            if(!threads.empty()) {
+                break;
+            }
+            
+            AssetRequest request;
+            {
+                lock_guard<mutex> guard(requests_lock);
+                if(requests.empty()) {
+                    break;
+                }
+                request = requests.front();
+                requests.pop_front();
+            }
+            hand(parse(request));
+            continue;
+        }
+        
+        AssetUpload &upload = uploads[data->id];
+        if(upload) {
+            upload(*data);
+        }
+        upload = nullptr;
+        
+        uploaded++;
+        count++;
+    }
+    
+    return count;
+}
+
+int AssetLoader::requested(void) const {
+    return next_id;
+}
+
+float AssetLoader::progress(void) const {
+    if(0 == next_id) {
+        return 1.0f;
+    }
+    return 0.5f * (parsed.load(memory_order_relaxed) + uploaded) / next_id;
+}
+
+bool AssetLoader::done(void) const {
+    return uploaded == next_id;
+}
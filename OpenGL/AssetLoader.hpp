@@ -0,0 +1,131 @@
+//
+//  AssetLoader.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 30/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef AssetLoader_hpp
+#define AssetLoader_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GLPlatform.h"
+#include "LockFreeQueue.hpp"
+
+/**
+ *  Leaves the cores to the job system and the render
+ *  thread, as loading mostly waits on the disk.
+ */
+const int default_asset_threads = 1;
+
+enum AssetType {
+    ASSET_MODEL,
+    ASSET_TEXT,
+    ASSET_BINARY
+};
+
+typedef int AssetId;
+
+/**
+ *  What a loader thread hands back: the vertices of a
+ *  model, the source of a shader, or the bytes of a file.
+ */
+struct AssetData {
+    AssetId id;
+    AssetType type;
+    std::string path;
+    bool loaded;
+    std::vector<GLfloat> vertices;
+    std::string text;
+    std::vector<unsigned char> bytes;
+};
+
+/**
+ *  Called on the render thread once an asset is ready,
+ *  which is where anything that needs GL should happen.
+ */
+typedef std::function<void(AssetData &)> AssetUpload;
+
+/**
+ *  Reads and parses files on background threads so the render
+ *  thread can keep drawing. Finished assets come back through a
+ *  lock free queue, and update hands them to their upload calls
+ *  until the time it was given for this frame runs out.
+ *
+ *  Built with OPENGL_SINGLE_THREADED there are no loader threads
+ *  and update does the reading too, inside the same budget.
+ */
+class AssetLoader {
+
+private:
+    struct AssetRequest {
+        AssetId id;
+        AssetType type;
+        std::string path;
+    };
+    
+    std::vector<std::thread> threads;
+    std::deque<AssetRequest> requests;
+    std::mutex requests_lock;
+    std::condition_variable requests_ready;
+    
+    /**
+     *  Read by hand without the lock, so a loader
+     *  waiting on a full queue notices shutdown.
+     */
+    std::atomic<bool> stopping;
+    
+    /**
+     *  Upload calls stay on the render thread, keyed by id,
+     *  so only the parsed data has to cross between threads.
+     */
+    std::vector<AssetUpload> uploads;
+    LockFreeQueue<std::unique_ptr<AssetData>> finished;
+    
+    AssetId next_id = 0;
+    std::atomic<int> parsed;
+    int uploaded = 0;
+    
+    AssetLoader(const AssetLoader &);
+    void operator=(const AssetLoader &);
+    
+    void worker(void);
+    std::unique_ptr<AssetData> parse(const AssetRequest &request) const;
+    void hand(std::unique_ptr<AssetData> data);
+
+public:
+    explicit AssetLoader(int thread_count = default_asset_threads);
+    ~AssetLoader();
+    
+    /**
+     *  Queues a file to be read, and upload to be
+     *  called with it from a later update.
+     */
+    AssetId load(const std::string &path, AssetType type, const AssetUpload &upload);
+    
+    /**
+     *  Uploads finished assets until budget_ms has gone, always
+     *  doing at least one so loading can't stall. Returns how
+     *  many were uploaded.
+     */
+    int update(double budget_ms);
+    
+    /**
+     *  From 0 to 1, counting reading and uploading
+     *  as half the work each.
+     */
+    float progress(void) const;
+    bool done(void) const;
+    int requested(void) const;
+};
+
+#endif /* AssetLoader_hpp */
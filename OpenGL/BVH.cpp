@@ -0,0 +1,493 @@
+//
+//  BVH.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 21/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "BVH.hpp"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+#define bvh_bins 16
+
+struct BVHBin {
+    AABB bounds;
+    int count;
+};
+
+BVH::BVH() {}
+
+size_t BVH::size(void) const {
+    return items.size();
+}
+
+size_t BVH::nodeCount(void) const {
+    return nodes.size();
+}
+
+AABB BVH::bounds(void) const {
+    return nodes.empty() ? empty_aabb() : nodes[0].bounds;
+}
+
+void BVH::makeLeaf(BVHNode &node) {
+    node.left = -1;
+}
+
+void BVH::build(const vector<AABB> &bounds) {
+    
+    item_bounds = bounds;
+    nodes.clear();
+    items.resize(bounds.size());
+    iota(begin(items), end(items), 0);
+    
+    if(items.empty()) {
+        return;
+    }
+    
+    vector<vec3> centroids;
+    centroids.reserve(bounds.size());
+    for(const auto &box: bounds) {
+        centroids.push_back(aabb_centre(box));
+    }
+    
+    /**
+     *  A binary tree with leaves of at least one item
+     *  never has more than twice as many nodes as items.
+     */
+    nodes.reserve(items.size() * 2);
+    
+    BVHNode root;
+    root.first = 0;
+    root.count = (int)items.size();
+    root.left = -1;
+    root.bounds = empty_aabb();
+    for(const auto &box: bounds) {
+        root.bounds = aabb_merge(root.bounds, box);
+    }
+    nodes.push_back(root);
+    
+    vector<int> stack;
+    stack.push_back(0);
+    
+    while(!stack.empty()) {
+        int node_index = stack.back();
+        stack.pop_back();
+        
+        split(node_index, centroids);
+        
+        if(nodes[node_index].left != -1) {
+            stack.push_back(nodes[node_index].left);
+            stack.push_back(nodes[node_index].left + 1);
+        }
+    }
+}
+
+void BVH::split(int node_index, const vector<vec3> &centroids) {
+    
+    BVHNode node = nodes[node_index];
+    
+    if(node.count <= max_leaf_size) {
+        makeLeaf(nodes[node_index]);
+        return;
+    }
+    
+    /**
+     *  Bin on the axis where the item centres
+     *  are the most spread out.
+     */
+    AABB centre_bounds = empty_aabb();
+    for(int i = node.first; i < node.first + node.count; i++) {
+        const vec3 &c = centroids[items[i]];
+        AABB point;
+        point.min = c;
+        point.max = c;
+        centre_bounds = aabb_merge(centre_bounds, point);
+    }
+    
+    int axis = 0;
+    float extent = 0.0f;
+    for(int i = 0; i < 3; i++) {
+        float e = centre_bounds.max.v[i] - centre_bounds.min.v[i];
+        if(e > extent) {
+            extent = e;
+            axis = i;
+        }
+    }
+    
+    int best_split = -1;
+    float best_cost = 0.0f;
+    float axis_min = centre_bounds.min.v[axis];
+    float to_bin = extent > 0.0f ? (float)bvh_bins / extent : 0.0f;
+    
+    auto binOf = [&](int item) {
+        int b = (int)((centroids[item].v[axis] - axis_min) * to_bin);
+        return min(b, bvh_bins - 1);
+    };
+    
+    if(extent > 0.0f) {
+        BVHBin bins[bvh_bins];
+        for(auto &bin: bins) {
+            bin.bounds = empty_aabb();
+            bin.count = 0;
+        }
+        for(int i = node.first; i < node.first + node.count; i++) {
+            BVHBin &bin = bins[binOf(items[i])];
+            bin.bounds = aabb_merge(bin.bounds, item_bounds[items[i]]);
+            bin.count++;
+        }
+        
+        /**
+         *  Sweep from the right to get the area and count of
+         *  everything right of each split, then from the left
+         *  to find the split with the lowest cost:
+         *
+         *  area(left) * count(left) + area(right) * count(right)
+         */
+        float right_area[bvh_bins];
+        int right_count[bvh_bins];
+        AABB right = empty_aabb();
+        int count = 0;
+        for(int i = bvh_bins - 1; i > 0; i--) {
+            right = aabb_merge(right, bins[i].bounds);
+            count += bins[i].count;
+            right_area[i] = aabb_surface_area(right);
+            right_count[i] = count;
+        }
+        
+        AABB left = empty_aabb();
+        count = 0;
+        for(int i = 1; i < bvh_bins; i++) {
+            left = aabb_merge(left, bins[i - 1].bounds);
+            count += bins[i - 1].count;
+            if(count == 0 || right_count[i] == 0) {
+                continue;
+            }
+            float cost = aabb_surface_area(left) * count + right_area[i] * right_count[i];
+            if(best_split == -1 || cost < best_cost) {
+                best_split = i;
+                best_cost = cost;
+            }
+        }
+        
+        /**
+         *  Small nodes that gain nothing from
+         *  splitting are better off as leaves.
+         */
+        float leaf_cost = aabb_surface_area(node.bounds) * node.count;
+        if(best_split != -1 && best_cost >= leaf_cost && node.count <= max_leaf_size * 4) {
+            makeLeaf(nodes[node_index]);
+            return;
+        }
+    }
+    
+    int *first = &items[node.first];
+    int *last = first + node.count;
+    int *middle;
+    
+    if(best_split != -1) {
+        middle = partition(first, last, [&](int item) {
+            return binOf(item) < best_split;
+        });
+    }
+    else {
+        /**
+         *  Every centre is in the same place, so
+         *  just split the items down the middle.
+         */
+        middle = first + node.count / 2;
+        nth_element(first, middle, last, [&](int a, int b) {
+            return centroids[a].v[axis] < centroids[b].v[axis];
+        });
+    }
+    
+    int left_count = (int)(middle - first);
+    
+    BVHNode children[2];
+    children[0].first = node.first;
+    children[0].count = left_count;
+    children[1].first = node.first + left_count;
+    children[1].count = node.count - left_count;
+    
+    for(auto &child: children) {
+        child.left = -1;
+        child.bounds = empty_aabb();
+        for(int i = child.first; i < child.first + child.count; i++) {
+            child.bounds = aabb_merge(child.bounds, item_bounds[items[i]]);
+        }
+    }
+    
+    nodes[node_index].left = (int)nodes.size();
+    nodes.push_back(children[0]);
+    nodes.push_back(children[1]);
+}
+
+void BVH::refit(const vector<AABB> &bounds) {
+    
+    if(bounds.size() != item_bounds.size()) {
+        build(bounds);
+        return;
+    }
+    
+    item_bounds = bounds;
+    
+    /**
+     *  Children are always stored after their parent,
+     *  so walking backwards visits them first.
+     */
+    for(int i = (int)nodes.size() - 1; i >= 0; i--) {
+        BVHNode &node = nodes[i];
+        if(node.left == -1) {
+            node.bounds = empty_aabb();
+            for(int j = node.first; j < node.first + node.count; j++) {
+                node.bounds = aabb_merge(node.bounds, item_bounds[items[j]]);
+            }
+        }
+        else {
+            node.bounds = aabb_merge(nodes[node.left].bounds, nodes[node.left + 1].bounds);
+        }
+    }
+}
+
+void BVH::cull(const Frustum &frustum, vector<int> &visible) const {
+    
+    visible.clear();
+    
+    if(nodes.empty()) {
+        return;
+    }
+    
+    struct Entry {
+        int node;
+        unsigned int plane_mask;
+    };
+    
+    vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({0, all_frustum_planes});
+    
+    while(!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        
+        const BVHNode &node = nodes[entry.node];
+        unsigned int mask = entry.plane_mask;
+        FrustumTest test = frustum.classifyBox(node.bounds, mask);
+        
+        if(OUTSIDE == test) {
+            continue;
+        }
+        
+        /**
+         *  Everything under this node is visible,
+         *  so there is nothing more to test.
+         */
+        if(INSIDE == test) {
+            visible.insert(end(visible), begin(items) + node.first, begin(items) + node.first + node.count);
+            continue;
+        }
+        
+        if(node.left == -1) {
+            for(int i = node.first; i < node.first + node.count; i++) {
+                unsigned int item_mask = mask;
+                if(OUTSIDE != frustum.classifyBox(item_bounds[items[i]], item_mask)) {
+                    visible.push_back(items[i]);
+                }
+            }
+            continue;
+        }
+        
+        stack.push_back({node.left, mask});
+        stack.push_back({node.left + 1, mask});
+    }
+}
+
+void BVH::cull(const vector<Frustum> &frustums, vector<vector<int>> &visible) const {
+    
+    const int count = min((int)frustums.size(), bvh_max_frusta);
+    
+    visible.resize(frustums.size());
+    for(auto &list: visible) {
+        list.clear();
+    }
+    
+    if(nodes.empty() || count == 0) {
+        return;
+    }
+    
+    /**
+     *  Each entry carries which frusta still need to test the
+     *  node (view_mask) and, for each of them, which planes
+     *  it is not yet known to be inside of.
+     */
+    struct Entry {
+        int node;
+        unsigned int view_mask;
+        unsigned int plane_masks[bvh_max_frusta];
+    };
+    
+    vector<Entry> stack;
+    stack.reserve(64);
+    
+    Entry root;
+    root.node = 0;
+    root.view_mask = (1u << count) - 1;
+    for(int v = 0; v < count; v++) {
+        root.plane_masks[v] = all_frustum_planes;
+    }
+    stack.push_back(root);
+    
+    while(!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        
+        const BVHNode &node = nodes[entry.node];
+        unsigned int view_mask = 0;
+        
+        for(int v = 0; v < count; v++) {
+            if(!(entry.view_mask & (1u << v))) {
+                continue;
+            }
+            
+            FrustumTest test = frustums[v].classifyBox(node.bounds, entry.plane_masks[v]);
+            
+            if(INSIDE == test) {
+                visible[v].insert(end(visible[v]), begin(items) + node.first, begin(items) + node.first + node.count);
+            }
+            else if(INTERSECTS == test) {
+                view_mask |= 1u << v;
+            }
+        }
+        
+        if(!view_mask) {
+            continue;
+        }
+        
+        entry.view_mask = view_mask;
+        
+        if(node.left == -1) {
+            for(int i = node.first; i < node.first + node.count; i++) {
+                const AABB &box = item_bounds[items[i]];
+                for(int v = 0; v < count; v++) {
+                    unsigned int item_mask = entry.plane_masks[v];
+                    if((view_mask & (1u << v)) && OUTSIDE != frustums[v].classifyBox(box, item_mask)) {
+                        visible[v].push_back(items[i]);
+                    }
+                }
+            }
+            continue;
+        }
+        
+        entry.node = node.left;
+        stack.push_back(entry);
+        entry.node = node.left + 1;
+        stack.push_back(entry);
+    }
+}
+
+bool BVH::raycast(const Ray &ray, float max_distance, BVHHit &hit) const {
+    
+    hit.item = -1;
+    hit.distance = max_distance;
+    
+    float distance;
+    if(nodes.empty() || !ray_aabb(ray, nodes[0].bounds, max_distance, distance)) {
+        return false;
+    }
+    
+    vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    
+    while(!stack.empty()) {
+        const BVHNode &node = nodes[stack.back()];
+        stack.pop_back();
+        
+        /**
+         *  Something closer may have been found since
+         *  this node was pushed, so test it again.
+         */
+        if(!ray_aabb(ray, node.bounds, hit.distance, distance)) {
+            continue;
+        }
+        
+        if(node.left == -1) {
+            for(int i = node.first; i < node.first + node.count; i++) {
+                if(ray_aabb(ray, item_bounds[items[i]], hit.distance, distance) && (hit.item == -1 || distance < hit.distance)) {
+                    hit.item = items[i];
+                    hit.distance = distance;
+                }
+            }
+            continue;
+        }
+        
+        /**
+         *  Visit the nearer child first by pushing it last,
+         *  which lets the further one be skipped more often.
+         */
+        float d0, d1;
+        bool hit0 = ray_aabb(ray, nodes[node.left].bounds, hit.distance, d0);
+        bool hit1 = ray_aabb(ray, nodes[node.left + 1].bounds, hit.distance, d1);
+        
+        if(hit0 && hit1) {
+            if(d0 < d1) {
+                stack.push_back(node.left + 1);
+                stack.push_back(node.left);
+            }
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.left + 1);
+            }
+        }
+        else if(hit0) {
+            stack.push_back(node.left);
+        }
+        else if(hit1) {
+            stack.push_back(node.left + 1);
+        }
+    }
+    
+    return hit.item != -1;
+}
+
+void BVH::raycastAll(const Ray &ray, float max_distance, vector<BVHHit> &hits) const {
+    
+    hits.clear();
+    
+    if(nodes.empty()) {
+        return;
+    }
+    
+    vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    
+    float distance;
+    while(!stack.empty()) {
+        const BVHNode &node = nodes[stack.back()];
+        stack.pop_back();
+        
+        if(!ray_aabb(ray, node.bounds, max_distance, distance)) {
+            continue;
+        }
+        
+        if(node.left == -1) {
+            for(int i = node.first; i < node.first + node.count; i++) {
+                if(ray_aabb(ray, item_bounds[items[i]], max_distance, distance)) {
+                    hits.push_back({items[i], distance});
+                }
+            }
+            continue;
+        }
+        
+        stack.push_back(node.left);
+        stack.push_back(node.left + 1);
+    }
+    
+    sort(begin(hits), end(hits), [](const BVHHit &a, const BVHHit &b) {
+        return a.distance < b.distance;
+    });
+}
@@ -0,0 +1,107 @@
+//
+//  BVH.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 21/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef BVH_hpp
+#define BVH_hpp
+
+#include <vector>
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+
+/**
+ *  The most frusta that can be culled in one walk of the tree.
+ */
+#define bvh_max_frusta 8
+
+/**
+ *  A node covers the items from first to first + count in the
+ *  item list, whether it is a leaf or not, so a node that is
+ *  completely visible can hand over all of its items at once.
+ *  Interior nodes keep their two children next to each other,
+ *  starting at left.
+ */
+struct BVHNode {
+    AABB bounds;
+    int first;
+    int count;
+    int left;
+};
+
+struct BVHHit {
+    int item;
+    float distance;
+};
+
+/**
+ *  Bounding volume hierarchy over the world bounds of a set
+ *  of items (usually meshes), where an item is just its index
+ *  in the bounds vector passed to build.
+ */
+class BVH {
+
+private:
+    std::vector<BVHNode> nodes;
+    std::vector<int> items;
+    std::vector<AABB> item_bounds;
+    
+    int max_leaf_size = 4;
+    
+    void split(int node_index, const std::vector<vec3> &centroids);
+    void makeLeaf(BVHNode &node);
+    
+public:
+    BVH();
+    
+    /**
+     *  Builds the tree from scratch using the surface area
+     *  heuristic, binning item centres along the widest axis.
+     */
+    void build(const std::vector<AABB> &bounds);
+    
+    /**
+     *  Updates the bounds of every node from new item bounds,
+     *  keeping the shape of the tree. This is much cheaper than
+     *  build for items that move a little each frame, but the
+     *  tree gets worse as they drift, so rebuild now and again.
+     */
+    void refit(const std::vector<AABB> &bounds);
+    
+    /**
+     *  Fills visible with the items whose bounds are
+     *  at least partly inside the frustum.
+     */
+    void cull(const Frustum &frustum, std::vector<int> &visible) const;
+    
+    /**
+     *  Culls against several frusta (up to bvh_max_frusta) in
+     *  one walk of the tree, filling visible[i] for frustums[i].
+     *  Nodes are only read and tested once for all the frusta
+     *  that can still see them, so views that look at the same
+     *  part of the scene share most of the work.
+     */
+    void cull(const std::vector<Frustum> &frustums, std::vector<std::vector<int>> &visible) const;
+    
+    /**
+     *  Finds the nearest item whose bounds are hit by the
+     *  ray within max_distance. Segments can be tested with
+     *  ray_from_points and the segment length.
+     */
+    bool raycast(const Ray &ray, float max_distance, BVHHit &hit) const;
+    
+    /**
+     *  Fills hits with every item whose bounds are
+     *  hit by the ray, nearest first.
+     */
+    void raycastAll(const Ray &ray, float max_distance, std::vector<BVHHit> &hits) const;
+    
+    size_t size(void) const;
+    size_t nodeCount(void) const;
+    AABB bounds(void) const;
+};
+
+#endif /* BVH_hpp */
@@ -0,0 +1,253 @@
+//
+//  Bounds.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 20/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "Bounds.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+void BoundingSpheres::clear(void) {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void BoundingSpheres::reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    radius.reserve(count);
+}
+
+void BoundingSpheres::push(const BoundingSphere &sphere) {
+    x.push_back(sphere.centre.v[0]);
+    y.push_back(sphere.centre.v[1]);
+    z.push_back(sphere.centre.v[2]);
+    radius.push_back(sphere.radius);
+}
+
+void BoundingSpheres::set(size_t index, const BoundingSphere &sphere) {
+    x[index] = sphere.centre.v[0];
+    y[index] = sphere.centre.v[1];
+    z[index] = sphere.centre.v[2];
+    radius[index] = sphere.radius;
+}
+
+size_t BoundingSpheres::size(void) const {
+    return radius.size();
+}
+
+/**
+ *  An empty box has its minimum above its maximum,
+ *  so merging anything in to it gives that thing back.
+ */
+AABB empty_aabb() {
+    const float big = numeric_limits<float>::max();
+    AABB box;
+    box.min = vec3(big, big, big);
+    box.max = vec3(-big, -big, -big);
+    return box;
+}
+
+bool aabb_is_empty(const AABB &box) {
+    return box.min.v[0] > box.max.v[0];
+}
+
+AABB aabb_from_points(const vector<Point> &points) {
+    AABB box = empty_aabb();
+    for(const auto &point: points) {
+        box.min.v[0] = min(box.min.v[0], point.x);
+        box.min.v[1] = min(box.min.v[1], point.y);
+        box.min.v[2] = min(box.min.v[2], point.z);
+        box.max.v[0] = max(box.max.v[0], point.x);
+        box.max.v[1] = max(box.max.v[1], point.y);
+        box.max.v[2] = max(box.max.v[2], point.z);
+    }
+    return box;
+}
+
+AABB aabb_merge(const AABB &a, const AABB &b) {
+    AABB box;
+    for(int i = 0; i < 3; i++) {
+        box.min.v[i] = min(a.min.v[i], b.min.v[i]);
+        box.max.v[i] = max(a.max.v[i], b.max.v[i]);
+    }
+    return box;
+}
+
+vec3 aabb_centre(const AABB &box) {
+    return vec3(
+        (box.min.v[0] + box.max.v[0]) * 0.5f,
+        (box.min.v[1] + box.max.v[1]) * 0.5f,
+        (box.min.v[2] + box.max.v[2]) * 0.5f
+    );
+}
+
+vec3 aabb_extent(const AABB &box) {
+    return vec3(
+        (box.max.v[0] - box.min.v[0]) * 0.5f,
+        (box.max.v[1] - box.min.v[1]) * 0.5f,
+        (box.max.v[2] - box.min.v[2]) * 0.5f
+    );
+}
+
+float aabb_surface_area(const AABB &box) {
+    if(aabb_is_empty(box)) {
+        return 0.0f;
+    }
+    float dx = box.max.v[0] - box.min.v[0];
+    float dy = box.max.v[1] - box.min.v[1];
+    float dz = box.max.v[2] - box.min.v[2];
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+/**
+ *  Transforms the centre of the box and then works out
+ *  the new extent from the absolute values of the rotation
+ *  and scale part of the matrix, so we never have to
+ *  transform all eight corners.
+ */
+AABB transform_aabb(const AABB &box, const mat4 &m) {
+    vec3 c = aabb_centre(box);
+    vec3 e = aabb_extent(box);
+    AABB result;
+    
+    for(int i = 0; i < 3; i++) {
+        float centre = m.m[12 + i];
+        float extent = 0.0f;
+        for(int j = 0; j < 3; j++) {
+            centre += m.m[j * 4 + i] * c.v[j];
+            extent += fabsf(m.m[j * 4 + i]) * e.v[j];
+        }
+        result.min.v[i] = centre - extent;
+        result.max.v[i] = centre + extent;
+    }
+    return result;
+}
+
+BoundingSphere sphere_from_aabb(const AABB &box) {
+    BoundingSphere sphere;
+    sphere.centre = aabb_centre(box);
+    sphere.radius = length(aabb_extent(box));
+    return sphere;
+}
+
+/**
+ *  Centres the sphere on the box but only makes it as big
+ *  as the furthest point, which is usually a tighter fit
+ *  than the corners of the box.
+ */
+BoundingSphere sphere_from_points(const vector<Point> &points, const AABB &box) {
+    BoundingSphere sphere;
+    sphere.centre = aabb_centre(box);
+    float radius2 = 0.0f;
+    for(const auto &point: points) {
+        float dx = point.x - sphere.centre.v[0];
+        float dy = point.y - sphere.centre.v[1];
+        float dz = point.z - sphere.centre.v[2];
+        radius2 = max(radius2, dx * dx + dy * dy + dz * dz);
+    }
+    sphere.radius = sqrtf(radius2);
+    return sphere;
+}
+
+/**
+ *  The radius grows by the largest scale found
+ *  along any of the matrix axes.
+ */
+BoundingSphere transform_sphere(const BoundingSphere &sphere, const mat4 &m) {
+    BoundingSphere result;
+    const vec3 &c = sphere.centre;
+    float scale2 = 0.0f;
+    
+    for(int i = 0; i < 3; i++) {
+        result.centre.v[i] = m.m[i] * c.v[0] + m.m[4 + i] * c.v[1] + m.m[8 + i] * c.v[2] + m.m[12 + i];
+        float axis2 = m.m[i * 4] * m.m[i * 4] + m.m[i * 4 + 1] * m.m[i * 4 + 1] + m.m[i * 4 + 2] * m.m[i * 4 + 2];
+        scale2 = max(scale2, axis2);
+    }
+    result.radius = sphere.radius * sqrtf(scale2);
+    return result;
+}
+
+bool aabb_contains(const AABB &box, const vec3 &point) {
+    for(int i = 0; i < 3; i++) {
+        if(point.v[i] < box.min.v[i] || point.v[i] > box.max.v[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Ray ray_from_points(const vec3 &from, const vec3 &to) {
+    Ray ray;
+    ray.origin = from;
+    ray.direction = normalise(vec3(
+        to.v[0] - from.v[0],
+        to.v[1] - from.v[1],
+        to.v[2] - from.v[2]
+    ));
+    return ray;
+}
+
+/**
+ *  Turns a position in the window (with 0,0 at the top left,
+ *  as GLFW gives us) in to a ray in world space. We unproject
+ *  the point on the near plane and the point on the far plane
+ *  and fire the ray from one through the other.
+ */
+Ray ray_from_screen(float x, float y, int viewport_w, int viewport_h, const mat4 &inv_view_proj, ClipDepth depth) {
+    mat4 inv = inv_view_proj;
+    float ndc_x = (2.0f * x) / (float)viewport_w - 1.0f;
+    float ndc_y = 1.0f - (2.0f * y) / (float)viewport_h;
+    
+    /**
+     *  Reversed depth has near at 1, and with an infinite far
+     *  plane 0 is at infinity, so aim part way there instead.
+     */
+    float near_z = CLIP_DEPTH_REVERSED == depth ? 1.0f : -1.0f;
+    float far_z = CLIP_DEPTH_REVERSED == depth ? 0.5f : 1.0f;
+    
+    vec4 near_point = inv * vec4(ndc_x, ndc_y, near_z, 1.0f);
+    vec4 far_point = inv * vec4(ndc_x, ndc_y, far_z, 1.0f);
+    
+    vec3 from(near_point.v[0] / near_point.v[3], near_point.v[1] / near_point.v[3], near_point.v[2] / near_point.v[3]);
+    vec3 to(far_point.v[0] / far_point.v[3], far_point.v[1] / far_point.v[3], far_point.v[2] / far_point.v[3]);
+    
+    return ray_from_points(from, to);
+}
+
+/**
+ *  Slab test. The ray is clipped against the pair of planes on
+ *  each axis, and it hits the box if there is anything left.
+ *  Division by a zero direction gives infinity, which the
+ *  comparisons handle for us.
+ */
+bool ray_aabb(const Ray &ray, const AABB &box, float max_distance, float &distance) {
+    float t_min = 0.0f;
+    float t_max = max_distance;
+    
+    for(int i = 0; i < 3; i++) {
+        float inv_d = 1.0f / ray.direction.v[i];
+        float t0 = (box.min.v[i] - ray.origin.v[i]) * inv_d;
+        float t1 = (box.max.v[i] - ray.origin.v[i]) * inv_d;
+        if(inv_d < 0.0f) {
+            swap(t0, t1);
+        }
+        t_min = t0 > t_min ? t0 : t_min;
+        t_max = t1 < t_max ? t1 : t_max;
+        if(t_max < t_min) {
+            return false;
+        }
+    }
+    
+    distance = t_min;
+    return true;
+}
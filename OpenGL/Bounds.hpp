@@ -0,0 +1,81 @@
+//
+//  Bounds.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 20/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef Bounds_hpp
+#define Bounds_hpp
+
+#include <cstddef>
+#include <vector>
+#include "Structs.h"
+#include "VecMat.hpp"
+
+/**
+ *  Axis aligned bounding box, stored
+ *  as its minimum and maximum corners.
+ */
+struct AABB {
+    vec3 min;
+    vec3 max;
+};
+
+struct BoundingSphere {
+    vec3 centre;
+    float radius;
+};
+
+/**
+ *  A ray starting at origin. The direction
+ *  should be normalised so distances along
+ *  the ray are in world units.
+ */
+struct Ray {
+    vec3 origin;
+    vec3 direction;
+};
+
+/**
+ *  Many bounding spheres stored as a structure of
+ *  arrays, so they can be tested several at a time.
+ */
+struct BoundingSpheres {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radius;
+    
+    void clear(void);
+    void reserve(size_t count);
+    void push(const BoundingSphere &sphere);
+    void set(size_t index, const BoundingSphere &sphere);
+    size_t size(void) const;
+};
+
+/**
+ *  Functions for bounds
+ */
+AABB empty_aabb();
+AABB aabb_from_points(const std::vector<Point> &points);
+AABB aabb_merge(const AABB &a, const AABB &b);
+AABB transform_aabb(const AABB &box, const mat4 &m);
+vec3 aabb_centre(const AABB &box);
+vec3 aabb_extent(const AABB &box);
+float aabb_surface_area(const AABB &box);
+bool aabb_is_empty(const AABB &box);
+BoundingSphere sphere_from_aabb(const AABB &box);
+BoundingSphere sphere_from_points(const std::vector<Point> &points, const AABB &box);
+BoundingSphere transform_sphere(const BoundingSphere &sphere, const mat4 &m);
+bool aabb_contains(const AABB &box, const vec3 &point);
+
+/**
+ *  Functions for rays
+ */
+Ray ray_from_points(const vec3 &from, const vec3 &to);
+Ray ray_from_screen(float x, float y, int viewport_w, int viewport_h, const mat4 &inv_view_proj, ClipDepth depth = CLIP_DEPTH_STANDARD);
+bool ray_aabb(const Ray &ray, const AABB &box, float max_distance, float &distance);
+
+#endif /* Bounds_hpp */
@@ -0,0 +1,162 @@
+//
+//  BufferArena.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 28/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "BufferArena.hpp"
+#include <algorithm>
+#include <vector>
+#include "GLState.hpp"
+
+using namespace std;
+
+BufferArena::BufferArena(GLenum _target, size_t _element_size, size_t capacity) : target(_target), element_size(_element_size), initial_capacity(max(capacity, (size_t)1)) {}
+
+BufferArena::~BufferArena() {
+    release();
+}
+
+/**
+ *  The buffer is made when it is first needed,
+ *  as there might be no GL context before that.
+ */
+void BufferArena::create(void) {
+    glGenBuffers(1, &buffer);
+    GLState::bindBuffer(target, buffer);
+    glBufferData(target, initial_capacity * element_size, NULL, GL_STATIC_DRAW);
+    allocator = RangeAllocator(initial_capacity);
+}
+
+void BufferArena::release(void) {
+    if(buffer) {
+        GLState::forgetBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    allocator = RangeAllocator();
+}
+
+GLuint BufferArena::getBuffer(void) const {
+    return buffer;
+}
+
+RangeStats BufferArena::stats(void) const {
+    return allocator.stats();
+}
+
+GLint BufferArena::first(RangeHandle handle) const {
+    return (GLint)allocator.offset(handle);
+}
+
+GLsizei BufferArena::count(RangeHandle handle) const {
+    return (GLsizei)allocator.size(handle);
+}
+
+/**
+ *  Copies the old contents out to a scratch buffer, makes
+ *  new storage for the same buffer name and copies it back.
+ */
+void BufferArena::grow(size_t new_capacity) {
+    const size_t old_bytes = allocator.stats().capacity * element_size;
+    
+    GLuint scratch;
+    glGenBuffers(1, &scratch);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+    glBufferData(GL_COPY_WRITE_BUFFER, old_bytes, NULL, GL_STREAM_COPY);
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_bytes);
+    
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, scratch);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, new_capacity * element_size, NULL, GL_STATIC_DRAW);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_bytes);
+    
+    GLState::forgetBuffer(scratch);
+    glDeleteBuffers(1, &scratch);
+    
+    allocator.grow(new_capacity);
+}
+
+RangeHandle BufferArena::allocate(const void *data, size_t count) {
+    if(!buffer) {
+        create();
+    }
+    
+    RangeHandle handle = allocator.allocate(count);
+    
+    if(no_range == handle) {
+        RangeStats stats = allocator.stats();
+        if(stats.free >= count) {
+            defragment();
+        }
+        else {
+            grow(max(stats.capacity * 2, stats.used + count));
+        }
+        handle = allocator.allocate(count);
+    }
+    
+    if(no_range == handle) {
+        grow(allocator.stats().capacity + count);
+        handle = allocator.allocate(count);
+    }
+    
+    if(data) {
+        GLState::bindBuffer(target, buffer);
+        glBufferSubData(target, allocator.offset(handle) * element_size, count * element_size, data);
+    }
+    return handle;
+}
+
+void BufferArena::free(RangeHandle handle) {
+    if(buffer && no_range != handle) {
+        allocator.free(handle);
+    }
+}
+
+/**
+ *  GL does not allow copies between overlapping parts
+ *  of the same buffer, so everything that moves goes
+ *  out to a scratch buffer first and then back in.
+ */
+void BufferArena::defragment(void) {
+    if(!buffer) {
+        return;
+    }
+    
+    vector<RangeMove> moves = allocator.defragment();
+    if(moves.empty()) {
+        return;
+    }
+    
+    size_t scratch_bytes = 0;
+    for(const auto &move: moves) {
+        scratch_bytes += move.size * element_size;
+    }
+    
+    GLuint scratch;
+    glGenBuffers(1, &scratch);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+    glBufferData(GL_COPY_WRITE_BUFFER, scratch_bytes, NULL, GL_STREAM_COPY);
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, buffer);
+    
+    size_t scratch_offset = 0;
+    for(const auto &move: moves) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.from * element_size, scratch_offset, move.size * element_size);
+        scratch_offset += move.size * element_size;
+    }
+    
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, scratch);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    
+    scratch_offset = 0;
+    for(const auto &move: moves) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, scratch_offset, move.to * element_size, move.size * element_size);
+        scratch_offset += move.size * element_size;
+    }
+    
+    GLState::forgetBuffer(scratch);
+    glDeleteBuffers(1, &scratch);
+}
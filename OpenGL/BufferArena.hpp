@@ -0,0 +1,72 @@
+//
+//  BufferArena.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 28/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef BufferArena_hpp
+#define BufferArena_hpp
+
+#include "GLPlatform.h"
+#include <cstddef>
+#include "RangeAllocator.hpp"
+
+/**
+ *  One big GL buffer that many meshes share, with ranges
+ *  handed out by a RangeAllocator. Offsets and sizes are in
+ *  elements (like vertices), not bytes, so an offset can be
+ *  passed straight to glDrawArrays as the first vertex.
+ *
+ *  The buffer keeps the same name when it grows or gets
+ *  defragmented, so VAOs pointing at it never need redoing,
+ *  but the ranges inside it can move, so look up first every
+ *  time rather than keeping hold of it.
+ */
+class BufferArena {
+
+private:
+    GLenum target;
+    size_t element_size;
+    size_t initial_capacity;
+    GLuint buffer = 0;
+    RangeAllocator allocator;
+    
+    BufferArena(const BufferArena &);
+    void operator=(const BufferArena &);
+    
+    void create(void);
+    void grow(size_t new_capacity);
+
+public:
+    BufferArena(GLenum target, size_t element_size, size_t capacity);
+    ~BufferArena();
+    
+    /**
+     *  Copies count elements in to a new range. If there is not
+     *  room, the arena is defragmented when that would free up
+     *  enough space in one piece, and grown when it would not.
+     */
+    RangeHandle allocate(const void *data, size_t count);
+    void free(RangeHandle handle);
+    
+    GLint first(RangeHandle handle) const;
+    GLsizei count(RangeHandle handle) const;
+    
+    /**
+     *  Packs all the ranges together at the start of the
+     *  buffer, copying the data on the GPU.
+     */
+    void defragment(void);
+    
+    /**
+     *  Deletes the GL buffer, and forgets every range.
+     */
+    void release(void);
+    
+    GLuint getBuffer(void) const;
+    RangeStats stats(void) const;
+};
+
+#endif /* BufferArena_hpp */
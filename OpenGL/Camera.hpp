@@ -9,13 +9,15 @@
 #ifndef Camera_hpp
 #define Camera_hpp
 
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <cmath>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include "VecMat.hpp"
+#include "Frustum.hpp"
+#include "PerspectiveCamera.hpp"
 
 enum CameraKey {
     MOVE_FORWARD,
@@ -29,9 +31,16 @@ enum CameraKey {
     YAW_LEFT,
     YAW_RIGHT,
     ROLL_LEFT,
-    ROLL_RIGHT
+    ROLL_RIGHT,
+    CAMERA_KEY_COUNT
 };
 
+/**
+ *  The one camera the demos drive from the keyboard. It holds a
+ *  PerspectiveCamera and sends its matrices to the current program,
+ *  so anything that wants to draw from somewhere else can make its
+ *  own PerspectiveCamera and leave this one alone.
+ */
 class Camera {
 
 private:
@@ -41,44 +50,26 @@ private:
     void operator=(Camera const &);
     static Camera& getInstance();
     
-    GLuint program;
-    int view_mat_location;
-    int proj_mat_location;
+    GLuint program = 0;
+    bool created = false;
+    int view_mat_location = -1;
+    int proj_mat_location = -1;
     
-    mat4 T;
-    mat4 R;
-    mat4 view_mat;
-    mat4 proj_mat;
-    vec3 cam_pos;
-    
-    vec4 fwd;
-    vec4 rgt;
-    vec4 up;
-    
-    float quaternion[4];
-    
-    int gl_viewport_h;
-    int gl_viewport_w;
-    float fov = 67.0f;
-    float near = 0.1f;
-    float far = 100.0f;
-    float aspect;
-    
-    float cam_speed = 0.25f;
-    float cam_heading_speed = 1.0f;
-    float cam_heading = 0.0f;
-    
-    void _create_versor(float *q, float a, float x, float y, float z);
-    void _quat_to_mat4(float *m, float *q);
-    void _mult_quat_quat(float *result, float *r, float *s);
-    void _normalise_quat(float *q);
+    PerspectiveCamera camera;
     
     void _applyProgram(GLuint _progam);
     
     void _updateViewportSize(const int _gl_viewport_w, const int gl_viewport_h);
     void _create(void);
+    void _input(const CameraInput &input);
     void _update(CameraKey key);
+    void _advance(double dt);
     void _updateFov(float _d);
+    Frustum _frustum(void);
+    Ray _screenRay(float x, float y);
+    vec3 _position(void);
+    float _farPlane(void);
+    PerspectiveCamera& _get(void);
 
     std::string _repr(void);
     
@@ -96,14 +87,59 @@ public:
         getInstance()._create();
     }
     
+    /**
+     *  Adds to this frame's input. Call as many
+     *  times as you like before advance.
+     */
+    static void input(const CameraInput &input) {
+        getInstance()._input(input);
+    }
+    
+    /**
+     *  Adds a held key to this frame's input.
+     */
     static void update(CameraKey key) {
         getInstance()._update(key);
     }
     
+    /**
+     *  Moves the camera on by dt seconds, once a frame.
+     *  Sending the new view to the shader is left to
+     *  whatever draws from it (like a RenderView).
+     */
+    static void advance(double dt) {
+        getInstance()._advance(dt);
+    }
+    
     static void updateFov(float _d) {
         getInstance()._updateFov(_d);
     }
     
+    static Frustum frustum(void) {
+        return getInstance()._frustum();
+    }
+    
+    static Ray screenRay(float x, float y) {
+        return getInstance()._screenRay(x, y);
+    }
+    
+    static vec3 position(void) {
+        return getInstance()._position();
+    }
+    
+    static float farPlane(void) {
+        return getInstance()._farPlane();
+    }
+    
+    /**
+     *  The camera itself, for drawing the scene from
+     *  it through something other than the shader set
+     *  by applyProgram (like a RenderView).
+     */
+    static PerspectiveCamera& get(void) {
+        return getInstance()._get();
+    }
+    
     static std::string repr(void) {
         return getInstance()._repr();
     }
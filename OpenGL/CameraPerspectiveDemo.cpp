@@ -7,6 +7,11 @@
 //
 
 #include "CameraPerspectiveDemo.hpp"
+#include "GLState.hpp"
+#include "ProgramCache.hpp"
+#include "ShaderPreprocessor.hpp"
+#include "MeshBuffers.hpp"
+#include "Logger.hpp"
 
 using namespace std;
 using namespace std::placeholders;
@@ -15,7 +20,7 @@ using namespace std::placeholders;
 #define gl_viewport_h 960
 
 CameraPerspectiveDemo::CameraPerspectiveDemo() {
-    cout << "Construct: CameraPerspectiveDemo" << endl;
+    LOG_DEBUG("Construct: CameraPerspectiveDemo");
     
     drawing_method = GL_TRIANGLES;
     
@@ -40,10 +45,15 @@ CameraPerspectiveDemo::CameraPerspectiveDemo() {
 }
 
 CameraPerspectiveDemo::~CameraPerspectiveDemo() {
-    cout << "Destruct: CameraPerspectiveDemo" << endl;
+    LOG_DEBUG("Destruct: CameraPerspectiveDemo");
     program = 0;
     window = 0;
+    for(auto &mesh: meshes) {
+        mesh.releaseBuffers();
+    }
     meshes.clear();
+    MeshBuffers::release();
+    ProgramCache::release();
     glfwTerminate();
 }
 
@@ -132,8 +142,12 @@ void CameraPerspectiveDemo::updateCameraFromMouse(void) {
  *  In the drawing loop we need points and a reference to this VAO.
  */
 void CameraPerspectiveDemo::prepareMeshes(void) {
+    mesh_bounds.clear();
+    mesh_bounds.reserve(meshes.size());
+    
     for(auto &mesh: meshes) {
         mesh.prepareBuffers();
+        mesh_bounds.push(mesh.getBoundingSphere());
     }
 }
 
@@ -161,17 +175,38 @@ void CameraPerspectiveDemo::addMesh(Mesh mesh, const Position position, const Ro
 void CameraPerspectiveDemo::drawLoop() {
     
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0, gl_viewport_w, gl_viewport_h);
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    GLState::viewport(0, 0, gl_viewport_w, gl_viewport_h);
+    GLState::clearColor(1.0f, 1.0f, 1.0f, 1.0f);
     
     if(GL_TRUE == GLUtilities::programReady(program)) {
-        for(auto &mesh: meshes) {
-            glBindVertexArray(mesh.getVao());
-            glDrawArrays(drawing_method, 0, mesh.pointsSize());
+        frustum.cull(mesh_bounds, mesh_visible);
+        
+        /**
+         *  Record the visible meshes and let the command
+         *  buffer group them by VAO before drawing.
+         */
+        commands.clear();
+        for(size_t i = 0; i < meshes.size(); i++) {
+            if(!mesh_visible[i]) {
+                continue;
+            }
+            
+            DrawCommand command;
+            command.program = program;
+            command.vao = meshes[i].getVao();
+            command.mode = drawing_method;
+            command.first = meshes[i].firstVertex();
+            command.count = meshes[i].pointsSize();
+            command.world = identity_mat4();
+            
+            commands.draw(CommandBuffer::sortKey(program, 0, command.vao, 0.0f), command);
         }
+        commands.sort();
+        commands.execute();
     }
     
     glfwPollEvents();
+    Input::getInstance().dispatch();
     glfwSwapBuffers(window);
 }
 
@@ -271,7 +306,7 @@ void CameraPerspectiveDemo::keyUp(int key, int scancode, int action, int mods) {
     camera_updating = false;
 }
 
-void CameraPerspectiveDemo::applyViewMatrix() const {
+void CameraPerspectiveDemo::applyViewMatrix() {
     /**
      *  The member variable cam_pos updates
      *  for each repaint. This is used when we
@@ -338,6 +373,14 @@ void CameraPerspectiveDemo::applyViewMatrix() const {
      */
     GLuint view_loc = glGetUniformLocation(program, "view");
     glUniformMatrix4fv(view_loc, 1, GL_FALSE, &view_matrix_unwound[0]);
+    
+    /**
+     *  Keep the frustum in step with the view
+     *  so the draw loop can skip what is off screen.
+     */
+    mat4 view_mat;
+    copy(begin(view_matrix_unwound), end(view_matrix_unwound), view_mat.m);
+    frustum.extract(proj_mat * view_mat);
 }
 
 int CameraPerspectiveDemo::run(void) {
@@ -379,16 +422,14 @@ int CameraPerspectiveDemo::run(void) {
     
     /**
      *  We then need to grab the vertex and fragment shaders, compile
-     *  both of them and then link them to form a program. We then
-     *  print the program status.
+     *  both of them and then link them to form a program (or load the
+     *  program binary a previous run saved). We then print the program
+     *  status.
      */
-    string vertex_shader_str = ShaderLoader::load("camera_perspective_demo.vert");
-    string fragment_shader_str = ShaderLoader::load("camera_perspective_demo.frag");
+    string vertex_shader_str = ShaderPreprocessor::load("mesh.vert");
+    string fragment_shader_str = ShaderPreprocessor::load("vertex_colour.frag");
     
-    GLuint vertex_shader = GLUtilities::compileShader(vertex_shader_str, GL_VERTEX_SHADER);
-    GLuint fragment_shader = GLUtilities::compileShader(fragment_shader_str, GL_FRAGMENT_SHADER);
-    
-    program = GLUtilities::linkShaders(vertex_shader, fragment_shader);
+    program = ProgramCache::program(vertex_shader_str, fragment_shader_str);
     GLParams::print_program_info_log(program);
     
     /**
@@ -399,7 +440,7 @@ int CameraPerspectiveDemo::run(void) {
     /**
      *  Then we use the compiled program.
      */
-    glUseProgram(program);
+    GLState::useProgram(program);
     
     /**
      *  Apply perspective, which is something we 
@@ -407,6 +448,10 @@ int CameraPerspectiveDemo::run(void) {
      */
     if(GLUtilities::programReady(program)) {
         GLUtilities::applyProjectionMatrix(gl_viewport_w, gl_viewport_h, fov, program, "projection");
+        
+        vector<GLfloat> proj_unwound = GLUtilities::calculateProjectionMatrix(gl_viewport_w, gl_viewport_h, fov).unwind();
+        copy(begin(proj_unwound), end(proj_unwound), proj_mat.m);
+        
         applyViewMatrix();
     }
     
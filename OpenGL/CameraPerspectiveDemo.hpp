@@ -9,7 +9,7 @@
 #ifndef CameraPerspectiveDemo_hpp
 #define CameraPerspectiveDemo_hpp
 
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <string>
 #include <sstream>
@@ -22,6 +22,9 @@
 #include "Structs.h"
 #include "Mesh.hpp"
 #include "Input.hpp"
+#include "VecMat.hpp"
+#include "Frustum.hpp"
+#include "CommandBuffer.hpp"
 
 #define one_deg_in_rad (2.0 * M_PI) / 360.0f
 
@@ -48,9 +51,19 @@ private:
 
     std::vector<Mesh> meshes;
     
+    /**
+     *  The shader here has no model matrix, so the meshes
+     *  are culled using the bounds they were created with.
+     */
+    mat4 proj_mat;
+    Frustum frustum;
+    BoundingSpheres mesh_bounds;
+    std::vector<unsigned char> mesh_visible;
+    CommandBuffer commands;
+    
     void prepareMeshes(void);    
     void drawLoop();
-    void applyViewMatrix() const;
+    void applyViewMatrix();
     
     void mouseDown(int button, int action, int mods);
     void mouseUp(int button, int action, int mods);
@@ -0,0 +1,165 @@
+//
+//  CommandBuffer.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 25/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "CommandBuffer.hpp"
+#include "GLState.hpp"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+#define world_matrix_uniform "identity_matrix"
+
+CommandBuffer::CommandBuffer() {}
+
+uint64_t CommandBuffer::sortKey(GLuint program, unsigned int material, GLuint vao, float depth) {
+    depth = min(max(depth, 0.0f), 1.0f);
+    uint64_t depth_bits = (uint64_t)(depth * 65535.0f);
+    
+    return ((uint64_t)(program & 0xffff) << 48) |
+           ((uint64_t)(material & 0xffff) << 32) |
+           ((uint64_t)(vao & 0xffff) << 16) |
+           depth_bits;
+}
+
+void CommandBuffer::draw(uint64_t key, const DrawCommand &command) {
+    keys.push_back(key);
+    commands.push_back(command);
+    sorted = false;
+}
+
+void CommandBuffer::append(const CommandBuffer &other) {
+    keys.insert(end(keys), begin(other.keys), end(other.keys));
+    commands.insert(end(commands), begin(other.commands), end(other.commands));
+    sorted = false;
+}
+
+void CommandBuffer::clear(void) {
+    keys.clear();
+    commands.clear();
+    order.clear();
+    sorted = false;
+}
+
+size_t CommandBuffer::size(void) const {
+    return commands.size();
+}
+
+/**
+ *  Least significant byte first. Each pass is a stable
+ *  counting sort, so earlier passes are kept in order by
+ *  later ones. The keys are moved along with the order so
+ *  each pass reads them one after the other.
+ */
+void CommandBuffer::sort(void) {
+    const size_t count = keys.size();
+    
+    order.resize(count);
+    iota(begin(order), end(order), 0);
+    sorted = true;
+    
+    if(count < 2) {
+        return;
+    }
+    
+    order_scratch.resize(count);
+    key_scratch.resize(count);
+    vector<uint64_t> sorted_keys(keys);
+    
+    for(int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {0};
+        for(size_t i = 0; i < count; i++) {
+            counts[(sorted_keys[i] >> shift) & 0xff]++;
+        }
+        
+        if(counts[(sorted_keys[0] >> shift) & 0xff] == count) {
+            continue;
+        }
+        
+        size_t offset = 0;
+        for(auto &c: counts) {
+            size_t n = c;
+            c = offset;
+            offset += n;
+        }
+        
+        for(size_t i = 0; i < count; i++) {
+            size_t to = counts[(sorted_keys[i] >> shift) & 0xff]++;
+            key_scratch[to] = sorted_keys[i];
+            order_scratch[to] = order[i];
+        }
+        
+        sorted_keys.swap(key_scratch);
+        order.swap(order_scratch);
+    }
+}
+
+GLint CommandBuffer::worldLocation(GLuint program) {
+    for(size_t i = 0; i < uniform_programs.size(); i++) {
+        if(uniform_programs[i] == program) {
+            return uniform_locations[i];
+        }
+    }
+    
+    GLint location = glGetUniformLocation(program, world_matrix_uniform);
+    uniform_programs.push_back(program);
+    uniform_locations.push_back(location);
+    return location;
+}
+
+CommandStats CommandBuffer::execute(void) {
+    CommandStats stats = {0, 0, 0, 0, 0};
+    
+    /**
+     *  Not sorted, so play them back in
+     *  the order they were recorded.
+     */
+    if(!sorted) {
+        order.resize(commands.size());
+        iota(begin(order), end(order), 0);
+    }
+    
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLint world_location = -1;
+    bool first = true;
+    
+    for(uint32_t i: order) {
+        const DrawCommand &command = commands[i];
+        
+        if(first || command.program != program) {
+            program = command.program;
+            GLState::useProgram(program);
+            world_location = worldLocation(program);
+            stats.program_binds++;
+        }
+        else {
+            stats.program_binds_skipped++;
+        }
+        
+        if(first || command.vao != vao) {
+            vao = command.vao;
+            GLState::bindVertexArray(vao);
+            stats.vao_binds++;
+        }
+        else {
+            stats.vao_binds_skipped++;
+        }
+        
+        first = false;
+        
+        if(world_location != -1) {
+            glUniformMatrix4fv(world_location, 1, GL_FALSE, command.world.m);
+        }
+        
+        glDrawArrays(command.mode, command.first, command.count);
+        stats.draws++;
+    }
+    
+    return stats;
+}
@@ -0,0 +1,112 @@
+//
+//  CommandBuffer.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 25/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef CommandBuffer_hpp
+#define CommandBuffer_hpp
+
+#include "GLPlatform.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "VecMat.hpp"
+
+/**
+ *  Everything needed to issue one draw call later on.
+ */
+struct DrawCommand {
+    GLuint program;
+    GLuint vao;
+    GLenum mode;
+    GLint first;
+    GLsizei count;
+    mat4 world;
+};
+
+/**
+ *  How much work execute did, and how many program
+ *  and VAO changes it managed to skip.
+ */
+struct CommandStats {
+    int draws;
+    int program_binds;
+    int vao_binds;
+    int program_binds_skipped;
+    int vao_binds_skipped;
+};
+
+/**
+ *  Collects draw calls during the frame instead of issuing
+ *  them straight away, sorts them so that draws sharing a
+ *  program and VAO end up next to each other, and then plays
+ *  them back only changing GL state when it has to.
+ *
+ *  Buffers can be filled on different threads and appended
+ *  to one another before sorting. Only execute touches GL.
+ */
+class CommandBuffer {
+
+private:
+    std::vector<uint64_t> keys;
+    std::vector<DrawCommand> commands;
+    
+    /**
+     *  The sorted order of the commands,
+     *  and scratch space for sorting.
+     */
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> order_scratch;
+    std::vector<uint64_t> key_scratch;
+    
+    /**
+     *  Whether order matches the commands. Anything that
+     *  adds or removes commands means sorting again.
+     */
+    bool sorted = false;
+    
+    /**
+     *  Where each program keeps its world matrix uniform.
+     */
+    std::vector<GLuint> uniform_programs;
+    std::vector<GLint> uniform_locations;
+    
+    GLint worldLocation(GLuint program);
+
+public:
+    CommandBuffer();
+    
+    /**
+     *  Packs program, material, VAO and depth in to one key, most
+     *  important first, so sorting the keys groups draws by program,
+     *  then material, then VAO, and draws the nearest first within
+     *  those. Depth runs from 0 (near) to 1 (far). Only the low
+     *  16 bits of each name are used, which is fine for sorting as
+     *  execute compares the real names.
+     */
+    static uint64_t sortKey(GLuint program, unsigned int material, GLuint vao, float depth);
+    
+    void draw(uint64_t key, const DrawCommand &command);
+    void append(const CommandBuffer &other);
+    void clear(void);
+    size_t size(void) const;
+    
+    /**
+     *  Radix sorts the commands by key. Passes over bytes that
+     *  are the same in every key are skipped, so keys that only
+     *  differ in a few places sort in a few passes.
+     */
+    void sort(void);
+    
+    /**
+     *  Issues the draw calls in sorted order, or in the order
+     *  they were recorded if sort has not been called since
+     *  the last one was added.
+     */
+    CommandStats execute(void);
+};
+
+#endif /* CommandBuffer_hpp */
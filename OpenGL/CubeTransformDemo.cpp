@@ -6,11 +6,23 @@
 //  Copyright © 2017 Matt Finucane. All rights reserved.
 //
 #include <iostream>
+#include <sstream>
+#include <algorithm>
 #include "CubeTransformDemo.hpp"
 #include "Enumerations.h"
+#include "GLState.hpp"
+#include "Logger.hpp"
 
 using namespace std;
 
+/**
+ *  How long each frame can spend uploading
+ *  loaded assets, in milliseconds.
+ */
+#define asset_upload_budget_ms 2.0
+
+#define window_title "CubeTransformDemo"
+
 /**
  *  Constructor for the CubeTransformDemo which initialises
  *  the GLFW window and compiles the shaders to link them and 
@@ -21,44 +33,60 @@ using namespace std;
  */
 CubeTransformDemo::CubeTransformDemo(vector<GLfloat> _vertex_floats, vector<GLfloat> _colour_floats)
 : vertex_floats(_vertex_floats), colour_floats(_colour_floats) {
+    LOG_DEBUG("Construct: CubeTransformDemo.");
+    prepare();
+}
+
+/**
+ *  Constructor for drawing a model loaded from a file. The
+ *  window opens straight away and the model turns up once
+ *  it has been read, rather than holding everything up.
+ *
+ *  @param  {const char *} - the path to the .obj file.
+ */
+CubeTransformDemo::CubeTransformDemo(const char *_model_path)
+: model_path(_model_path) {
     cout << "Construct: CubeTransformDemo." << endl;
-    
+    prepare();
+}
+
+/**
+ *  Initialises the GLFW window. The shaders are read
+ *  by the asset loader once run starts, and the program
+ *  is linked when both of them have arrived.
+ */
+void CubeTransformDemo::prepare(void) {
     try {
         /**
          *  Set up the window.
          */
         setupWindow();
-        
-        /**
-         *  Prepare the program by:
-         *  - loading the vertex shader and compiling it.
-         *  - loadig the fragment shader and compiling it.
-         *  - compiling and linking them to form a program.
-         */
-        string vertex_shader_str = ShaderLoader::load("cube_transform_demo.vert");
-        string fragment_shader_str = ShaderLoader::load("cube_transform_demo.frag");
-        
-        GLuint vertex_shader = compileShader(vertex_shader_str, GL_VERTEX_SHADER);
-        GLuint fragment_shader = compileShader(fragment_shader_str, GL_FRAGMENT_SHADER);
-        program = linkShaders(vertex_shader, fragment_shader);
-        GLParams::print_program_info_log(program);
-        
-        /**
-         *  Finally, we need to set the current adjustment 
-         *  matrix (transform, rotate, scale).
-         */
     }
     catch(exception &e) {
         cout << e.what() << endl;
     }
 }
 
+/**
+ *  Prepare the program by:
+ *  - compiling the vertex shader.
+ *  - compiling the fragment shader.
+ *  - linking them to form a program.
+ */
+void CubeTransformDemo::prepareProgram(const string &vertex_shader_str, const string &fragment_shader_str) {
+    GLuint vertex_shader = compileShader(vertex_shader_str, GL_VERTEX_SHADER);
+    GLuint fragment_shader = compileShader(fragment_shader_str, GL_FRAGMENT_SHADER);
+    program = linkShaders(vertex_shader, fragment_shader);
+    GLParams::print_program_info_log(program);
+    GLState::useProgram(program);
+}
+
 /**
  *  Destructor for the CubeTransformDemo which terminates
  *  GLFW and does other cleanup tasks.
  */
 CubeTransformDemo::~CubeTransformDemo() {
-    cout << "Destruct: CubeTransformDemo." << endl;
+    LOG_DEBUG("Destruct: CubeTransformDemo.");
     delete m;
     window = 0;
     program = 0;
@@ -95,7 +123,7 @@ bool CubeTransformDemo::setupWindow(void) {
     /**
      *  Then we create the window.
      */
-    window = glfwCreateWindow(1280, 960, "CubeTransformDemo", NULL, NULL);
+    window = glfwCreateWindow(1280, 960, window_title, NULL, NULL);
     if(!window) {
         glfwTerminate();
         throw runtime_error("GLFW failed to initialise a new window. Exiting");
@@ -106,27 +134,28 @@ bool CubeTransformDemo::setupWindow(void) {
      *  Set this window as the current context for GLFW
      */
     glfwMakeContextCurrent(window);
+    GLState::invalidate();
     
     /**
      *  Some stuff needed for perspective and drawing 
      *  items that are in front of other items.
      */
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_LESS);
     
     /**
      *  Set up back face culling so fragments aren't 
      *  shaded for the part of a mesh we cannot see.
      */
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    GLState::enable(GL_CULL_FACE);
+    GLState::cullFace(GL_BACK);
     
     /**
      *  This is needed to tell OpenGL what the front 
      *  and back of a primative is, given we specify
      *  vertices in a clockwise form.
      */
-    glFrontFace(GL_CW);
+    GLState::frontFace(GL_CW);
     
     return true;
 };
@@ -211,7 +240,7 @@ GLuint CubeTransformDemo::prepareMesh(const vector<GLfloat> points, const vector
      */
     GLuint points_vbo;
     glGenBuffers(1, &points_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, points_vbo);
     glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(float), &points[0], GL_STATIC_DRAW);
     
     /**
@@ -219,7 +248,7 @@ GLuint CubeTransformDemo::prepareMesh(const vector<GLfloat> points, const vector
      */
     GLuint colours_vbo;
     glGenBuffers(1, &colours_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, colours_vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, colours_vbo);
     glBufferData(GL_ARRAY_BUFFER, colours.size() * sizeof(float), &colours[0], GL_STATIC_DRAW);
     
     /**
@@ -227,15 +256,15 @@ GLuint CubeTransformDemo::prepareMesh(const vector<GLfloat> points, const vector
      */
     GLuint vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    GLState::bindVertexArray(vao);
     
     /**
      *  Then we bind the buffers for the points and colours
      *  and set the vertex attribute pointers.
      */
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, points_vbo);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glBindBuffer(GL_ARRAY_BUFFER, colours_vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, colours_vbo);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
     
     /**
@@ -255,17 +284,19 @@ void CubeTransformDemo::drawLoop(GLuint vao) {
      *  Standard GL setup for each frame draw.
      */
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0, 1280, 960);
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    GLState::viewport(0, 0, 1280, 960);
+    GLState::clearColor(1.0f, 1.0f, 1.0f, 1.0f);
     
     /**
      *  Ensure the program is ready and if it is, we can draw.
      */
-    int program_ready;
-    glGetProgramiv(program, GL_LINK_STATUS, &program_ready);
+    int program_ready = GL_FALSE;
+    if(program) {
+        glGetProgramiv(program, GL_LINK_STATUS, &program_ready);
+    }
     
-    if(GL_TRUE == program_ready) {
-        glBindVertexArray(vao);
+    if(GL_TRUE == program_ready && vao) {
+        GLState::bindVertexArray(vao);
         glDrawArrays(GL_TRIANGLES, 0, vertex_floats.size() / 3);
     }
     
@@ -380,17 +411,79 @@ void CubeTransformDemo::keyActionListener(void) {
     }
 }
 
+/**
+ *  Colours every fourth and eighth component, the same
+ *  stripes the cube and model demos have always used.
+ */
+vector<GLfloat> CubeTransformDemo::stripeColours(size_t count) {
+    vector<GLfloat> colours(count);
+    
+    int i = 0;
+    
+    transform(begin(colours), end(colours), begin(colours), [&i](GLfloat c) {
+        GLfloat x = 0;
+        if(i++ == 0) x = 1.0f;
+        else if(i % 4 == 0) x =  1.0f;
+        else if(i % 8 == 0) x = 1.0f;
+        return x;
+    });
+    
+    return colours;
+}
+
+void CubeTransformDemo::showProgress(float progress) {
+    stringstream title;
+    title << window_title;
+    if(progress < 1.0f) {
+        title << " - loading " << (int)(progress * 100.0f) << "%";
+    }
+    glfwSetWindowTitle(window, title.str().c_str());
+}
+
 int CubeTransformDemo::run(void) {
     
     /**
-     *  Prepare the mesh to be drawn.
+     *  Ask for the shaders, and link them once both are
+     *  in. Neither has any includes, so the loader reads
+     *  the same source ShaderPreprocessor would give back.
      */
-    GLuint mesh_vao = prepareMesh(vertex_floats, colour_floats);
+    AssetLoader loader;
+    string vertex_shader_str;
+    string fragment_shader_str;
+    
+    auto shader_upload = [this, &vertex_shader_str, &fragment_shader_str](string &source) {
+        return [this, &source, &vertex_shader_str, &fragment_shader_str](AssetData &data) {
+            if(!data.loaded || data.text.empty()) {
+                return;
+            }
+            source = data.text;
+            if(!vertex_shader_str.empty() && !fragment_shader_str.empty()) {
+                prepareProgram(vertex_shader_str, fragment_shader_str);
+            }
+        };
+    };
+    loader.load("cube_transform_demo.vert", ASSET_TEXT, shader_upload(vertex_shader_str));
+    loader.load("vertex_colour.frag", ASSET_TEXT, shader_upload(fragment_shader_str));
     
     /**
-     *  Use the program we have compiled.
+     *  Prepare the mesh to be drawn, or ask for the model
+     *  to be loaded and prepare it when it arrives.
      */
-    glUseProgram(program);
+    GLuint mesh_vao = 0;
+    
+    if(model_path.empty()) {
+        mesh_vao = prepareMesh(vertex_floats, colour_floats);
+    }
+    else {
+        loader.load(model_path, ASSET_MODEL, [this, &mesh_vao](AssetData &data) {
+            if(!data.loaded || data.vertices.empty()) {
+                return;
+            }
+            vertex_floats = data.vertices;
+            colour_floats = stripeColours(vertex_floats.size());
+            mesh_vao = prepareMesh(vertex_floats, colour_floats);
+        });
+    }
     
     /**
      *  While GLFW determines that the window 
@@ -403,7 +496,13 @@ int CubeTransformDemo::run(void) {
      *  no longer evaluate to true.
      */
     while(!glfwWindowShouldClose(window)) {
-        applyMatrices();
+        if(!loader.done()) {
+            loader.update(asset_upload_budget_ms);
+            showProgress(loader.progress());
+        }
+        if(program) {
+            applyMatrices();
+        }
         drawLoop(mesh_vao);
         keyActionListener();
     }
@@ -9,7 +9,7 @@
 #ifndef CubeTransformDemo_hpp
 #define CubeTransformDemo_hpp
 
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <string>
 #include <vector>
@@ -17,18 +17,25 @@
 #include "ShaderLoader.hpp"
 #include "GLParams.hpp"
 #include "Matrices.hpp"
+#include "AssetLoader.hpp"
 
 class CubeTransformDemo {
 private:
     /**
      *  private variables
      */
-    GLuint program;
+    GLuint program = 0;
     GLFWwindow *window;
     std::vector<GLfloat> vertex_floats;
     std::vector<GLfloat> colour_floats;
     GLuint vao;
     
+    /**
+     *  Set when the mesh comes from a model file, which
+     *  is loaded in the background once the window is up.
+     */
+    std::string model_path;
+    
     /**
      *  Matrices for transformation and rotation.
      */
@@ -54,12 +61,16 @@ private:
     void applyMatrices(void);
     void keyActionListener(void);
     void prepare(void);
+    void prepareProgram(const std::string &vertex_shader_str, const std::string &fragment_shader_str);
+    void showProgress(float progress);
+    static std::vector<GLfloat> stripeColours(size_t count);
     
 public:
     /**  
      *  public functions
      */
     CubeTransformDemo(std::vector<GLfloat> _vertex_floats, std::vector<GLfloat> _colour_floats);
+    CubeTransformDemo(const char *_model_path);
     ~CubeTransformDemo();
     int run(void);
 };
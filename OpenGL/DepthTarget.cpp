@@ -0,0 +1,146 @@
+//
+//  DepthTarget.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 05/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "DepthTarget.hpp"
+#include <iostream>
+#include <cstring>
+#include "GLState.hpp"
+
+using namespace std;
+
+/**
+ *  From ARB_clip_control, which has the same
+ *  values as the GL 4.5 core enums.
+ */
+#ifndef GL_LOWER_LEFT
+    #define GL_LOWER_LEFT 0x8CA1
+#endif
+#ifndef GL_ZERO_TO_ONE
+    #define GL_ZERO_TO_ONE 0x935F
+#endif
+#ifndef GL_NEGATIVE_ONE_TO_ONE
+    #define GL_NEGATIVE_ONE_TO_ONE 0x935E
+#endif
+
+DepthTarget::DepthTarget() {}
+
+DepthTarget::~DepthTarget() {
+    release();
+}
+
+void DepthTarget::release(void) {
+    if(framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colour);
+        glDeleteRenderbuffers(1, &depth);
+    }
+    framebuffer = colour = depth = 0;
+}
+
+/**
+ *  glClipControl is only in the headers from 4.5 on,
+ *  so without them we can't call it even if the
+ *  driver has the extension.
+ */
+bool DepthTarget::clipControlSupported(void) {
+#if defined(GL_VERSION_4_5)
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    
+    if(major > 4 || (major == 4 && minor >= 5)) {
+        return true;
+    }
+    
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0; i < count; i++) {
+        const GLubyte *extension = glGetStringi(GL_EXTENSIONS, i);
+        if(extension && 0 == strcmp((const char *)extension, "GL_ARB_clip_control")) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+bool DepthTarget::createFramebuffer(void) {
+    glGenRenderbuffers(1, &colour);
+    glBindRenderbuffer(GL_RENDERBUFFER, colour);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    if(GL_FRAMEBUFFER_COMPLETE != status) {
+        cout << "Float depth framebuffer incomplete: " << status << endl;
+        release();
+        return false;
+    }
+    return true;
+}
+
+ClipDepth DepthTarget::create(GLsizei w, GLsizei h) {
+    release();
+    width = w;
+    height = h;
+    clip_depth = CLIP_DEPTH_STANDARD;
+    
+    if(clipControlSupported() && createFramebuffer()) {
+        clip_depth = CLIP_DEPTH_REVERSED;
+    }
+    
+#if defined(GL_VERSION_4_5)
+    if(clipControlSupported()) {
+        glClipControl(GL_LOWER_LEFT, CLIP_DEPTH_REVERSED == clip_depth ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE);
+    }
+#endif
+    
+    if(CLIP_DEPTH_REVERSED == clip_depth) {
+        glClearDepth(0.0);
+        GLState::depthFunc(GL_GREATER);
+    }
+    else {
+        glClearDepth(1.0);
+        GLState::depthFunc(GL_LESS);
+    }
+    
+    return clip_depth;
+}
+
+void DepthTarget::bind(void) {
+    if(framebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void DepthTarget::resolve(void) {
+    if(!framebuffer) {
+        return;
+    }
+    
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+ClipDepth DepthTarget::clipDepth(void) const {
+    return clip_depth;
+}
@@ -0,0 +1,63 @@
+//
+//  DepthTarget.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 05/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef DepthTarget_hpp
+#define DepthTarget_hpp
+
+#include "GLPlatform.h"
+#include "VecMat.hpp"
+
+/**
+ *  Where the scene is drawn before it goes to the window, set up
+ *  for reversed depth where the driver allows it:
+ *
+ *  -   glClipControl (GL 4.5 or ARB_clip_control) for a [0, 1]
+ *      clip range, so depth isn't squashed back in to [-1, 1].
+ *  -   A 32 bit float depth buffer, which the window's own
+ *      framebuffer can't give us, so we draw in to our own and
+ *      copy the colour across at the end of the frame.
+ *  -   Depth cleared to 0 and tested with GL_GREATER.
+ *
+ *  Without all of that it draws straight in to the window with
+ *  standard depth. Cameras should use whichever clipDepth says.
+ */
+class DepthTarget {
+
+private:
+    GLuint framebuffer = 0;
+    GLuint colour = 0;
+    GLuint depth = 0;
+    GLsizei width = 0;
+    GLsizei height = 0;
+    ClipDepth clip_depth = CLIP_DEPTH_STANDARD;
+    
+    bool clipControlSupported(void);
+    bool createFramebuffer(void);
+    void release(void);
+
+public:
+    DepthTarget();
+    ~DepthTarget();
+    
+    /**
+     *  Sets up the depth state for the current context. Can
+     *  be called again if the window changes size.
+     */
+    ClipDepth create(GLsizei w, GLsizei h);
+    
+    /**
+     *  Bind before drawing the frame, and resolve before
+     *  swapping buffers to copy the result to the window.
+     */
+    void bind(void);
+    void resolve(void);
+    
+    ClipDepth clipDepth(void) const;
+};
+
+#endif /* DepthTarget_hpp */
@@ -9,6 +9,7 @@
 #ifndef Detect_hpp
 #define Detect_hpp
 
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <iostream>
 
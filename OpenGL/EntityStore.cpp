@@ -0,0 +1,244 @@
+//
+//  EntityStore.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 23/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "EntityStore.hpp"
+
+using namespace std;
+
+/**
+ *  Fewer entities than this are not worth handing to another thread.
+ */
+#define entity_store_grain 256
+
+bool Entity::operator==(const Entity &rhs) const {
+    return index == rhs.index && generation == rhs.generation;
+}
+
+bool Entity::operator!=(const Entity &rhs) const {
+    return !(*this == rhs);
+}
+
+EntityStore::EntityStore() {}
+
+Entity EntityStore::create(void) {
+    Entity entity;
+    
+    /**
+     *  Reuse the index of a destroyed entity
+     *  if there is one, rather than growing.
+     */
+    if(!free_indices.empty()) {
+        entity.index = free_indices.back();
+        free_indices.pop_back();
+    }
+    else {
+        entity.index = (unsigned int)generations.size();
+        generations.push_back(0);
+        dense.push_back(-1);
+    }
+    entity.generation = generations[entity.index];
+    
+    versor rotation;
+    rotation.q[0] = 1.0f;
+    rotation.q[1] = 0.0f;
+    rotation.q[2] = 0.0f;
+    rotation.q[3] = 0.0f;
+    
+    AABB point;
+    point.min = vec3(0.0f, 0.0f, 0.0f);
+    point.max = vec3(0.0f, 0.0f, 0.0f);
+    
+    dense[entity.index] = (int)entities.size();
+    entities.push_back(entity);
+    positions.push_back(vec3(0.0f, 0.0f, 0.0f));
+    rotations.push_back(rotation);
+    scales.push_back(vec3(1.0f, 1.0f, 1.0f));
+    worlds.push_back(identity_mat4());
+    local_bounds.push_back(point);
+    world_bounds.push_back(point);
+    meshes.push_back(no_mesh);
+    dirty.push_back(0);
+    
+    return entity;
+}
+
+/**
+ *  Moves the last entity in to the gap so
+ *  the component arrays stay packed.
+ */
+void EntityStore::destroy(Entity entity) {
+    int i = indexOf(entity);
+    if(i == -1) {
+        return;
+    }
+    
+    int last = (int)entities.size() - 1;
+    if(i != last) {
+        entities[i] = entities[last];
+        positions[i] = positions[last];
+        rotations[i] = rotations[last];
+        scales[i] = scales[last];
+        worlds[i] = worlds[last];
+        local_bounds[i] = local_bounds[last];
+        world_bounds[i] = world_bounds[last];
+        meshes[i] = meshes[last];
+        dirty[i] = dirty[last];
+        dense[entities[i].index] = i;
+    }
+    
+    entities.pop_back();
+    positions.pop_back();
+    rotations.pop_back();
+    scales.pop_back();
+    worlds.pop_back();
+    local_bounds.pop_back();
+    world_bounds.pop_back();
+    meshes.pop_back();
+    dirty.pop_back();
+    
+    dense[entity.index] = -1;
+    generations[entity.index]++;
+    free_indices.push_back(entity.index);
+}
+
+bool EntityStore::alive(Entity entity) const {
+    return entity.index < generations.size() && generations[entity.index] == entity.generation && dense[entity.index] != -1;
+}
+
+void EntityStore::clear(void) {
+    while(!entities.empty()) {
+        destroy(entities.back());
+    }
+    any_dirty = false;
+}
+
+int EntityStore::indexOf(Entity entity) const {
+    return alive(entity) ? dense[entity.index] : -1;
+}
+
+Entity EntityStore::entityAt(size_t i) const {
+    return entities[i];
+}
+
+size_t EntityStore::size(void) const {
+    return entities.size();
+}
+
+void EntityStore::markDirty(int i) {
+    dirty[i] = 1;
+    any_dirty = true;
+}
+
+void EntityStore::setPosition(Entity entity, const vec3 &position) {
+    int i = indexOf(entity);
+    if(i != -1) {
+        positions[i] = position;
+        markDirty(i);
+    }
+}
+
+void EntityStore::setRotation(Entity entity, const versor &rotation) {
+    int i = indexOf(entity);
+    if(i != -1) {
+        rotations[i] = rotation;
+        markDirty(i);
+    }
+}
+
+void EntityStore::setScale(Entity entity, const vec3 &scale) {
+    int i = indexOf(entity);
+    if(i != -1) {
+        scales[i] = scale;
+        markDirty(i);
+    }
+}
+
+void EntityStore::setBounds(Entity entity, const AABB &bounds) {
+    int i = indexOf(entity);
+    if(i != -1) {
+        local_bounds[i] = bounds;
+        world_bounds[i] = transform_aabb(bounds, worlds[i]);
+    }
+}
+
+void EntityStore::setMesh(Entity entity, int mesh) {
+    int i = indexOf(entity);
+    if(i != -1) {
+        meshes[i] = mesh;
+    }
+}
+
+void EntityStore::setWorld(Entity entity, const mat4 &world) {
+    int i = indexOf(entity);
+    if(i != -1) {
+        worlds[i] = world;
+        world_bounds[i] = transform_aabb(local_bounds[i], world);
+        dirty[i] = 0;
+    }
+}
+
+void EntityStore::updateRange(size_t begin, size_t end) {
+    for(size_t i = begin; i < end; i++) {
+        if(!dirty[i]) {
+            continue;
+        }
+        worlds[i] = compose_trs(positions[i], rotations[i], scales[i]);
+        world_bounds[i] = transform_aabb(local_bounds[i], worlds[i]);
+        dirty[i] = 0;
+    }
+}
+
+void EntityStore::update(void) {
+    if(!any_dirty) {
+        return;
+    }
+    updateRange(0, entities.size());
+    any_dirty = false;
+}
+
+/**
+ *  Every entity is independent of the others, so
+ *  the arrays are just split between the workers.
+ */
+void EntityStore::update(JobSystem &jobs) {
+    if(!any_dirty) {
+        return;
+    }
+    jobs.parallelFor(entities.size(), entity_store_grain, [this](size_t begin, size_t end) {
+        updateRange(begin, end);
+    });
+    any_dirty = false;
+}
+
+const vector<vec3>& EntityStore::getPositions() const {
+    return positions;
+}
+
+const vector<versor>& EntityStore::getRotations() const {
+    return rotations;
+}
+
+const vector<vec3>& EntityStore::getScales() const {
+    return scales;
+}
+
+const vector<mat4>& EntityStore::getWorlds() const {
+    return worlds;
+}
+
+const vector<AABB>& EntityStore::getBounds() const {
+    return local_bounds;
+}
+
+const vector<AABB>& EntityStore::getWorldBounds() const {
+    return world_bounds;
+}
+
+const vector<int>& EntityStore::getMeshes() const {
+    return meshes;
+}
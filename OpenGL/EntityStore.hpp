@@ -0,0 +1,126 @@
+//
+//  EntityStore.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 23/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef EntityStore_hpp
+#define EntityStore_hpp
+
+#include <cstddef>
+#include <vector>
+#include "VecMat.hpp"
+#include "Bounds.hpp"
+#include "JobSystem.hpp"
+
+/**
+ *  Handle to an entity. The index is reused once the
+ *  entity is destroyed, but the generation goes up each
+ *  time, so an old handle never points at a new entity.
+ */
+struct Entity {
+    unsigned int index;
+    unsigned int generation;
+    
+    bool operator==(const Entity &rhs) const;
+    bool operator!=(const Entity &rhs) const;
+};
+
+const int no_mesh = -1;
+
+/**
+ *  Keeps each component of every entity in its own tightly
+ *  packed array, so a pass over (say) the world bounds only
+ *  pulls world bounds through the cache.
+ *
+ *  The arrays have no gaps: destroying an entity moves the
+ *  last one in to its place. That means the position of an
+ *  entity in the arrays can change, so hold on to the Entity
+ *  handle and look it up with indexOf when needed.
+ */
+class EntityStore {
+
+private:
+    /**
+     *  Indexed by the handle index.
+     */
+    std::vector<unsigned int> generations;
+    std::vector<int> dense;
+    std::vector<unsigned int> free_indices;
+    
+    /**
+     *  The components, all indexed by the dense index.
+     */
+    std::vector<Entity> entities;
+    std::vector<vec3> positions;
+    std::vector<versor> rotations;
+    std::vector<vec3> scales;
+    std::vector<mat4> worlds;
+    std::vector<AABB> local_bounds;
+    std::vector<AABB> world_bounds;
+    std::vector<int> meshes;
+    std::vector<unsigned char> dirty;
+    
+    bool any_dirty = false;
+    
+    void markDirty(int i);
+    void updateRange(size_t begin, size_t end);
+
+public:
+    EntityStore();
+    
+    Entity create(void);
+    void destroy(Entity entity);
+    bool alive(Entity entity) const;
+    void clear(void);
+    
+    /**
+     *  Where the entity currently sits in the component
+     *  arrays, or -1 if it has been destroyed.
+     */
+    int indexOf(Entity entity) const;
+    Entity entityAt(size_t i) const;
+    size_t size(void) const;
+    
+    void setPosition(Entity entity, const vec3 &position);
+    void setRotation(Entity entity, const versor &rotation);
+    void setScale(Entity entity, const vec3 &scale);
+    void setBounds(Entity entity, const AABB &bounds);
+    void setMesh(Entity entity, int mesh);
+    
+    /**
+     *  For entities placed by something else, like a
+     *  SceneGraph. The world bounds are updated straight
+     *  away and the position, rotation and scale are left
+     *  alone.
+     */
+    void setWorld(Entity entity, const mat4 &world);
+    
+    /**
+     *  Works out the world matrix and world bounds of every
+     *  entity whose position, rotation or scale has changed
+     *  since the last update.
+     */
+    void update(void);
+    
+    /**
+     *  Same as above, split between the
+     *  workers of the job system.
+     */
+    void update(JobSystem &jobs);
+    
+    /**
+     *  The component arrays, for passes over every entity.
+     */
+    const std::vector<vec3>& getPositions() const;
+    const std::vector<versor>& getRotations() const;
+    const std::vector<vec3>& getScales() const;
+    const std::vector<mat4>& getWorlds() const;
+    const std::vector<AABB>& getBounds() const;
+    const std::vector<AABB>& getWorldBounds() const;
+    const std::vector<int>& getMeshes() const;
+};
+
+#endif /* EntityStore_hpp */
@@ -0,0 +1,145 @@
+//
+//  FileWatcher.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 03/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "FileWatcher.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+using namespace std;
+
+#define file_watch_interval_ms 250
+
+#if defined(__linux__)
+#define file_watch_events (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+#endif
+
+static string folder_of(const string &path) {
+    size_t slash = path.find_last_of('/');
+    return string::npos == slash ? "." : path.substr(0, slash);
+}
+
+static string name_of(const string &path) {
+    size_t slash = path.find_last_of('/');
+    return string::npos == slash ? path : path.substr(slash + 1);
+}
+
+FileWatcher::FileWatcher() : last_check(chrono::steady_clock::now()) {
+#if defined(__linux__)
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotify_fd < 0) {
+        cerr << "Could not start inotify, falling back to polling." << endl;
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#if defined(__linux__)
+    if(inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+#endif
+}
+
+time_t FileWatcher::modified(const string &path) {
+    struct stat info;
+    return 0 == stat(path.c_str(), &info) ? info.st_mtime : 0;
+}
+
+void FileWatcher::watch(const string &path) {
+    if(files.count(path)) {
+        return;
+    }
+    files[path] = modified(path);
+    
+#if defined(__linux__)
+    if(inotify_fd >= 0) {
+        const string folder = folder_of(path);
+        int descriptor = inotify_add_watch(inotify_fd, folder.c_str(), file_watch_events);
+        if(descriptor < 0) {
+            cerr << "Could not watch: " << folder << endl;
+        }
+        else {
+            folders[descriptor] = folder;
+        }
+    }
+#endif
+}
+
+void FileWatcher::unwatchAll(void) {
+#if defined(__linux__)
+    for(auto &folder: folders) {
+        inotify_rm_watch(inotify_fd, folder.first);
+    }
+    folders.clear();
+#endif
+    files.clear();
+}
+
+vector<string> FileWatcher::poll(void) {
+    vector<string> changed;
+    
+#if defined(__linux__)
+    if(inotify_fd >= 0) {
+        alignas(struct inotify_event) char buffer[4096];
+        
+        for(;;) {
+            ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+            if(length <= 0) {
+                break;
+            }
+            
+            for(char *at = buffer; at < buffer + length; ) {
+                const struct inotify_event *event = (const struct inotify_event *)at;
+                at += sizeof(struct inotify_event) + event->len;
+                
+                auto folder = folders.find(event->wd);
+                if(folder == folders.end() || 0 == event->len) {
+                    continue;
+                }
+                
+                /**
+                 *  Every file in the folder shows up here,
+                 *  so only keep the ones being watched.
+                 */
+                for(const auto &file: files) {
+                    if(folder_of(file.first) == folder->second && name_of(file.first) == event->name) {
+                        changed.push_back(file.first);
+                    }
+                }
+            }
+        }
+        
+        sort(begin(changed), end(changed));
+        changed.erase(unique(begin(changed), end(changed)), end(changed));
+        return changed;
+    }
+#endif
+    
+    const auto now = chrono::steady_clock::now();
+    if(chrono::duration_cast<chrono::milliseconds>(now - last_check).count() < file_watch_interval_ms) {
+        return changed;
+    }
+    last_check = now;
+    
+    for(auto &file: files) {
+        time_t time = modified(file.first);
+        if(time != file.second) {
+            file.second = time;
+            changed.push_back(file.first);
+        }
+    }
+    
+    return changed;
+}
@@ -0,0 +1,57 @@
+//
+//  FileWatcher.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 03/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef FileWatcher_hpp
+#define FileWatcher_hpp
+
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ *  Tells us when files we care about have been written, so
+ *  things like shaders can be reloaded without a restart.
+ *
+ *  On Linux this uses inotify on the folder each file is in,
+ *  as most editors save by writing a new file and renaming it
+ *  over the old one. Elsewhere (MacOS) it compares modified
+ *  times, at most every file_watch_interval_ms.
+ */
+class FileWatcher {
+
+private:
+    std::map<std::string, time_t> files;
+    std::chrono::steady_clock::time_point last_check;
+    
+#if defined(__linux__)
+    int inotify_fd = -1;
+    std::map<int, std::string> folders;
+#endif
+    
+    FileWatcher(const FileWatcher &);
+    void operator=(const FileWatcher &);
+    
+    static time_t modified(const std::string &path);
+
+public:
+    FileWatcher();
+    ~FileWatcher();
+    
+    void watch(const std::string &path);
+    void unwatchAll(void);
+    
+    /**
+     *  The watched files that changed since the last
+     *  call. Never blocks.
+     */
+    std::vector<std::string> poll(void);
+};
+
+#endif /* FileWatcher_hpp */
@@ -0,0 +1,249 @@
+//
+//  Frustum.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 20/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "Frustum.hpp"
+#include <cmath>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+using namespace std;
+
+Frustum::Frustum() {
+    for(int i = 0; i < 6; i++) {
+        planes[i] = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+}
+
+Frustum::Frustum(const mat4 &view_proj, ClipDepth depth) {
+    extract(view_proj, depth);
+}
+
+/**
+ *  Pulls the planes out of a combined projection * view
+ *  matrix (Gribb and Hartmann). Each plane is the fourth
+ *  row of the matrix plus or minus one of the other rows.
+ *
+ *  The matrices are column major, so row r is made up
+ *  of the elements m[r], m[4 + r], m[8 + r] and m[12 + r].
+ *
+ *  With reversed depth, near is where z = w and far is
+ *  where z = 0, so near is the fourth row minus the third
+ *  and far is the third row on its own.
+ */
+void Frustum::extract(const mat4 &view_proj, ClipDepth depth) {
+    const float *m = view_proj.m;
+    
+    for(int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        float w = 1.0f;
+        
+        if(CLIP_DEPTH_REVERSED == depth && PLANE_NEAR == i) {
+            sign = -1.0f;
+        }
+        else if(CLIP_DEPTH_REVERSED == depth && PLANE_FAR == i) {
+            sign = 1.0f;
+            w = 0.0f;
+        }
+        
+        float a = w * m[3] + sign * m[row];
+        float b = w * m[7] + sign * m[4 + row];
+        float c = w * m[11] + sign * m[8 + row];
+        float d = w * m[15] + sign * m[12 + row];
+        
+        /**
+         *  Normalise so the plane equation gives
+         *  us a real distance we can compare radii to.
+         */
+        float len = sqrtf(a * a + b * b + c * c);
+        if(len > 0.0f) {
+            a /= len;
+            b /= len;
+            c /= len;
+            d /= len;
+        }
+        planes[i] = vec4(a, b, c, d);
+    }
+}
+
+const vec4& Frustum::plane(FrustumPlane which) const {
+    return planes[which];
+}
+
+bool Frustum::sphereVisible(const BoundingSphere &sphere) const {
+    for(int i = 0; i < 6; i++) {
+        const float *p = planes[i].v;
+        float distance =
+            p[0] * sphere.centre.v[0] +
+            p[1] * sphere.centre.v[1] +
+            p[2] * sphere.centre.v[2] +
+            p[3];
+        if(distance < -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ *  Only the corner of the box furthest along the plane
+ *  normal needs checking. If even that is behind a plane,
+ *  the whole box is.
+ */
+bool Frustum::boxVisible(const AABB &box) const {
+    for(int i = 0; i < 6; i++) {
+        const float *p = planes[i].v;
+        float x = p[0] >= 0.0f ? box.max.v[0] : box.min.v[0];
+        float y = p[1] >= 0.0f ? box.max.v[1] : box.min.v[1];
+        float z = p[2] >= 0.0f ? box.max.v[2] : box.min.v[2];
+        if(p[0] * x + p[1] * y + p[2] * z + p[3] < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FrustumTest Frustum::classifyBox(const AABB &box, unsigned int &plane_mask) const {
+    for(int i = 0; i < 6; i++) {
+        unsigned int bit = 1u << i;
+        if(!(plane_mask & bit)) {
+            continue;
+        }
+        
+        /**
+         *  The nearest and furthest corners of
+         *  the box along the plane normal.
+         */
+        const float *p = planes[i].v;
+        float far_d = p[3];
+        float near_d = p[3];
+        for(int axis = 0; axis < 3; axis++) {
+            float lo = p[axis] * box.min.v[axis];
+            float hi = p[axis] * box.max.v[axis];
+            far_d += lo > hi ? lo : hi;
+            near_d += lo > hi ? hi : lo;
+        }
+        
+        if(far_d < 0.0f) {
+            return OUTSIDE;
+        }
+        if(near_d >= 0.0f) {
+            plane_mask &= ~bit;
+        }
+    }
+    return plane_mask == 0 ? INSIDE : INTERSECTS;
+}
+
+size_t Frustum::cull(const BoundingSpheres &spheres, vector<unsigned char> &visible) const {
+    
+    const size_t count = spheres.size();
+    const float *xs = spheres.x.data();
+    const float *ys = spheres.y.data();
+    const float *zs = spheres.z.data();
+    const float *rs = spheres.radius.data();
+    
+    visible.resize(count);
+    size_t visible_count = 0;
+    size_t i = 0;
+    
+#if defined(__AVX__)
+    /**
+     *  Eight spheres at a time. Each lane keeps track of
+     *  whether its sphere has fallen behind any plane.
+     */
+    __m256 pa[6], pb[6], pc[6], pd[6];
+    for(int p = 0; p < 6; p++) {
+        pa[p] = _mm256_set1_ps(planes[p].v[0]);
+        pb[p] = _mm256_set1_ps(planes[p].v[1]);
+        pc[p] = _mm256_set1_ps(planes[p].v[2]);
+        pd[p] = _mm256_set1_ps(planes[p].v[3]);
+    }
+    
+    const __m256 zero = _mm256_setzero_ps();
+    
+    for(; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 z = _mm256_loadu_ps(zs + i);
+        __m256 neg_r = _mm256_sub_ps(zero, _mm256_loadu_ps(rs + i));
+        __m256 outside = zero;
+        
+        for(int p = 0; p < 6; p++) {
+            __m256 d = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(pa[p], x), _mm256_mul_ps(pb[p], y)),
+                _mm256_add_ps(_mm256_mul_ps(pc[p], z), pd[p])
+            );
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, neg_r, _CMP_LT_OQ));
+        }
+        
+        int mask = _mm256_movemask_ps(outside);
+        for(int lane = 0; lane < 8; lane++) {
+            unsigned char in = ((mask >> lane) & 1) ? 0 : 1;
+            visible[i + lane] = in;
+            visible_count += in;
+        }
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    /**
+     *  Four spheres at a time, as above.
+     */
+    __m128 pa[6], pb[6], pc[6], pd[6];
+    for(int p = 0; p < 6; p++) {
+        pa[p] = _mm_set1_ps(planes[p].v[0]);
+        pb[p] = _mm_set1_ps(planes[p].v[1]);
+        pc[p] = _mm_set1_ps(planes[p].v[2]);
+        pd[p] = _mm_set1_ps(planes[p].v[3]);
+    }
+    
+    const __m128 zero = _mm_setzero_ps();
+    
+    for(; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 z = _mm_loadu_ps(zs + i);
+        __m128 neg_r = _mm_sub_ps(zero, _mm_loadu_ps(rs + i));
+        __m128 outside = zero;
+        
+        for(int p = 0; p < 6; p++) {
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(pa[p], x), _mm_mul_ps(pb[p], y)),
+                _mm_add_ps(_mm_mul_ps(pc[p], z), pd[p])
+            );
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, neg_r));
+        }
+        
+        int mask = _mm_movemask_ps(outside);
+        for(int lane = 0; lane < 4; lane++) {
+            unsigned char in = ((mask >> lane) & 1) ? 0 : 1;
+            visible[i + lane] = in;
+            visible_count += in;
+        }
+    }
+#endif
+    
+    /**
+     *  Whatever is left over (or everything, on
+     *  CPUs without SIMD) is tested one at a time.
+     */
+    for(; i < count; i++) {
+        bool in = true;
+        for(int p = 0; p < 6 && in; p++) {
+            const float *pl = planes[p].v;
+            float d = pl[0] * xs[i] + pl[1] * ys[i] + pl[2] * zs[i] + pl[3];
+            in = d >= -rs[i];
+        }
+        visible[i] = in ? 1 : 0;
+        visible_count += visible[i];
+    }
+    
+    return visible_count;
+}
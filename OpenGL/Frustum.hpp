@@ -0,0 +1,80 @@
+//
+//  Frustum.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 20/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef Frustum_hpp
+#define Frustum_hpp
+
+#include <vector>
+#include "VecMat.hpp"
+#include "Bounds.hpp"
+
+enum FrustumPlane {
+    PLANE_LEFT,
+    PLANE_RIGHT,
+    PLANE_BOTTOM,
+    PLANE_TOP,
+    PLANE_NEAR,
+    PLANE_FAR
+};
+
+enum FrustumTest {
+    OUTSIDE,
+    INSIDE,
+    INTERSECTS
+};
+
+/**
+ *  One bit per plane, for telling classifyBox
+ *  which planes still need to be tested.
+ */
+const unsigned int all_frustum_planes = 0x3f;
+
+/**
+ *  The six planes of a camera frustum, each stored as
+ *  (a, b, c, d) with a normal pointing in to the frustum,
+ *  so a point is inside when a*x + b*y + c*z + d >= 0.
+ */
+class Frustum {
+
+private:
+    vec4 planes[6];
+    
+public:
+    Frustum();
+    Frustum(const mat4 &view_proj, ClipDepth depth = CLIP_DEPTH_STANDARD);
+    
+    /**
+     *  The near and far planes depend on how the projection
+     *  lays out depth, so pass the one it was built with.
+     *  An infinite far plane gives a far plane that
+     *  everything is inside of.
+     */
+    void extract(const mat4 &view_proj, ClipDepth depth = CLIP_DEPTH_STANDARD);
+    const vec4& plane(FrustumPlane which) const;
+    
+    bool sphereVisible(const BoundingSphere &sphere) const;
+    bool boxVisible(const AABB &box) const;
+    
+    /**
+     *  Works out whether a box is completely outside, completely
+     *  inside or crossing the frustum. Only the planes set in
+     *  plane_mask are tested, and the bits for planes the box is
+     *  completely inside of are cleared, so children of the box
+     *  can skip them.
+     */
+    FrustumTest classifyBox(const AABB &box, unsigned int &plane_mask) const;
+    
+    /**
+     *  Tests all of the spheres against the frustum, several at a
+     *  time where the CPU allows it. Writes 1 for visible and 0 for
+     *  culled in to visible, and returns how many were visible.
+     */
+    size_t cull(const BoundingSpheres &spheres, std::vector<unsigned char> &visible) const;
+};
+
+#endif /* Frustum_hpp */
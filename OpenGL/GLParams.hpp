@@ -11,6 +11,7 @@
 
 #include <vector>
 #include <string>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 
 class GLParams {
@@ -0,0 +1,41 @@
+//
+//  GLPlatform.h
+//  OpenGL
+//
+//  Created by Matt Finucane on 20/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef GLPlatform_h
+#define GLPlatform_h
+
+/**
+ *  Every file that needs OpenGL types or functions should
+ *  include this instead of a platform header directly.
+ *
+ *  -   MacOS ships a core profile header in the OpenGL framework
+ *      which stops at 4.1.
+ *  -   Everywhere else we use the Khronos core profile header
+ *      and ask it for prototypes, which the system libGL exports.
+ *
+ *  Features newer than 4.1 should be guarded with GL_VERSION_4_x
+ *  checks so the MacOS build keeps compiling.
+ */
+#if defined(__APPLE__)
+    #include <OpenGL/gl3.h>
+#else
+    #ifndef GL_GLEXT_PROTOTYPES
+        #define GL_GLEXT_PROTOTYPES 1
+    #endif
+    #include <GL/glcorearb.h>
+#endif
+
+/**
+ *  GLFW would otherwise pull in the legacy
+ *  gl.h header on top of the one above.
+ */
+#ifndef GLFW_INCLUDE_NONE
+    #define GLFW_INCLUDE_NONE
+#endif
+
+#endif /* GLPlatform_h */
@@ -0,0 +1,220 @@
+//
+//  GLState.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 26/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "GLState.hpp"
+#include <sstream>
+
+using namespace std;
+
+GLState::GLState() {
+    _invalidate();
+    _resetCounters();
+}
+
+GLState& GLState::getInstance() {
+    static GLState instance;
+    return instance;
+}
+
+/**
+ *  Forget everything, so the next call
+ *  of each kind goes through to GL.
+ */
+void GLState::_invalidate(void) {
+    known_program = false;
+    known_vao = false;
+    buffer_targets.clear();
+    buffers.clear();
+    known_viewport = false;
+    known_clear_colour = false;
+    caps.clear();
+    cap_enabled.clear();
+    known_depth_func = false;
+    known_cull_face = false;
+    known_front_face = false;
+}
+
+/**
+ *  Counts the call and returns true if
+ *  it needs to go through to GL.
+ */
+bool GLState::changed(GLStateCall call, bool same) {
+    if(same) {
+        counters[call].elided++;
+        return false;
+    }
+    counters[call].issued++;
+    return true;
+}
+
+void GLState::_useProgram(GLuint _program) {
+    if(changed(CALL_USE_PROGRAM, known_program && program == _program)) {
+        glUseProgram(_program);
+        program = _program;
+        known_program = true;
+    }
+}
+
+/**
+ *  The element array buffer belongs to the VAO, so we
+ *  no longer know which one is bound once it changes.
+ */
+void GLState::_bindVertexArray(GLuint _vao) {
+    if(changed(CALL_BIND_VERTEX_ARRAY, known_vao && vao == _vao)) {
+        glBindVertexArray(_vao);
+        vao = _vao;
+        known_vao = true;
+        
+        for(size_t i = 0; i < buffer_targets.size(); i++) {
+            if(GL_ELEMENT_ARRAY_BUFFER == buffer_targets[i]) {
+                buffer_targets.erase(buffer_targets.begin() + i);
+                buffers.erase(buffers.begin() + i);
+                break;
+            }
+        }
+    }
+}
+
+void GLState::_bindBuffer(GLenum target, GLuint buffer) {
+    size_t i = 0;
+    while(i < buffer_targets.size() && buffer_targets[i] != target) {
+        i++;
+    }
+    
+    bool known = i < buffer_targets.size();
+    if(changed(CALL_BIND_BUFFER, known && buffers[i] == buffer)) {
+        glBindBuffer(target, buffer);
+        if(known) {
+            buffers[i] = buffer;
+        }
+        else {
+            buffer_targets.push_back(target);
+            buffers.push_back(buffer);
+        }
+    }
+}
+
+void GLState::_viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+    bool same = known_viewport && viewport_rect[0] == x && viewport_rect[1] == y && viewport_rect[2] == w && viewport_rect[3] == h;
+    if(changed(CALL_VIEWPORT, same)) {
+        glViewport(x, y, w, h);
+        viewport_rect[0] = x;
+        viewport_rect[1] = y;
+        viewport_rect[2] = w;
+        viewport_rect[3] = h;
+        known_viewport = true;
+    }
+}
+
+void GLState::_clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    bool same = known_clear_colour && clear_colour[0] == r && clear_colour[1] == g && clear_colour[2] == b && clear_colour[3] == a;
+    if(changed(CALL_CLEAR_COLOUR, same)) {
+        glClearColor(r, g, b, a);
+        clear_colour[0] = r;
+        clear_colour[1] = g;
+        clear_colour[2] = b;
+        clear_colour[3] = a;
+        known_clear_colour = true;
+    }
+}
+
+void GLState::_setEnabled(GLenum cap, bool enabled) {
+    size_t i = 0;
+    while(i < caps.size() && caps[i] != cap) {
+        i++;
+    }
+    
+    bool known = i < caps.size();
+    if(changed(CALL_ENABLE, known && cap_enabled[i] == enabled)) {
+        if(enabled) {
+            glEnable(cap);
+        }
+        else {
+            glDisable(cap);
+        }
+        
+        if(known) {
+            cap_enabled[i] = enabled;
+        }
+        else {
+            caps.push_back(cap);
+            cap_enabled.push_back(enabled);
+        }
+    }
+}
+
+void GLState::_depthFunc(GLenum func) {
+    if(changed(CALL_DEPTH_FUNC, known_depth_func && depth_func == func)) {
+        glDepthFunc(func);
+        depth_func = func;
+        known_depth_func = true;
+    }
+}
+
+void GLState::_cullFace(GLenum mode) {
+    if(changed(CALL_CULL_FACE, known_cull_face && cull_face == mode)) {
+        glCullFace(mode);
+        cull_face = mode;
+        known_cull_face = true;
+    }
+}
+
+void GLState::_frontFace(GLenum mode) {
+    if(changed(CALL_FRONT_FACE, known_front_face && front_face == mode)) {
+        glFrontFace(mode);
+        front_face = mode;
+        known_front_face = true;
+    }
+}
+
+/**
+ *  GL binds 0 in place of anything that is deleted while bound.
+ */
+void GLState::_forgetProgram(GLuint _program) {
+    if(known_program && program == _program) {
+        known_program = false;
+    }
+}
+
+void GLState::_forgetVertexArray(GLuint _vao) {
+    if(known_vao && vao == _vao) {
+        vao = 0;
+    }
+}
+
+void GLState::_forgetBuffer(GLuint buffer) {
+    for(auto &bound: buffers) {
+        if(bound == buffer) {
+            bound = 0;
+        }
+    }
+}
+
+void GLState::_resetCounters(void) {
+    for(auto &counter: counters) {
+        counter.issued = 0;
+        counter.elided = 0;
+    }
+}
+
+string GLState::_repr(void) {
+    const char *names[CALL_COUNT] = {
+        "program", "vao", "buffer", "viewport", "clear colour",
+        "enable", "depth func", "cull face", "front face"
+    };
+    
+    stringstream ss;
+    ss << "GL calls (issued/elided):";
+    for(int i = 0; i < CALL_COUNT; i++) {
+        if(counters[i].issued + counters[i].elided == 0) {
+            continue;
+        }
+        ss << " " << names[i] << " " << counters[i].issued << "/" << counters[i].elided;
+    }
+    return ss.str();
+}
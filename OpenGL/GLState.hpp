@@ -0,0 +1,173 @@
+//
+//  GLState.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 26/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef GLState_hpp
+#define GLState_hpp
+
+#include "GLPlatform.h"
+#include <string>
+#include <vector>
+
+enum GLStateCall {
+    CALL_USE_PROGRAM,
+    CALL_BIND_VERTEX_ARRAY,
+    CALL_BIND_BUFFER,
+    CALL_VIEWPORT,
+    CALL_CLEAR_COLOUR,
+    CALL_ENABLE,
+    CALL_DEPTH_FUNC,
+    CALL_CULL_FACE,
+    CALL_FRONT_FACE,
+    CALL_COUNT
+};
+
+/**
+ *  How many of each call were passed on to GL
+ *  and how many were skipped because nothing
+ *  would have changed.
+ */
+struct GLStateCounter {
+    unsigned long issued;
+    unsigned long elided;
+};
+
+/**
+ *  Keeps a copy of the GL state we set, so calls that would
+ *  set something to what it already is never reach the driver.
+ *
+ *  Everything that binds or enables things has to go through
+ *  here for the copy to stay right. Call invalidate after making
+ *  a new context current, and forget any program, VAO or buffer
+ *  that gets deleted, as GL unbinds it and its name can be reused.
+ */
+class GLState {
+
+private:
+    GLState();
+    ~GLState() {};
+    GLState(GLState const &);
+    void operator=(GLState const &);
+    static GLState& getInstance();
+    
+    bool known_program;
+    GLuint program;
+    bool known_vao;
+    GLuint vao;
+    
+    std::vector<GLenum> buffer_targets;
+    std::vector<GLuint> buffers;
+    
+    bool known_viewport;
+    GLint viewport_rect[4];
+    bool known_clear_colour;
+    GLfloat clear_colour[4];
+    
+    std::vector<GLenum> caps;
+    std::vector<bool> cap_enabled;
+    
+    bool known_depth_func;
+    GLenum depth_func;
+    bool known_cull_face;
+    GLenum cull_face;
+    bool known_front_face;
+    GLenum front_face;
+    
+    GLStateCounter counters[CALL_COUNT];
+    
+    bool changed(GLStateCall call, bool same);
+    
+    void _invalidate(void);
+    void _useProgram(GLuint _program);
+    void _bindVertexArray(GLuint _vao);
+    void _bindBuffer(GLenum target, GLuint buffer);
+    void _viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+    void _clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+    void _setEnabled(GLenum cap, bool enabled);
+    void _depthFunc(GLenum func);
+    void _cullFace(GLenum mode);
+    void _frontFace(GLenum mode);
+    void _forgetProgram(GLuint _program);
+    void _forgetVertexArray(GLuint _vao);
+    void _forgetBuffer(GLuint buffer);
+    void _resetCounters(void);
+    std::string _repr(void);
+
+public:
+    static void invalidate(void) {
+        getInstance()._invalidate();
+    }
+    
+    static void useProgram(GLuint program) {
+        getInstance()._useProgram(program);
+    }
+    
+    static void bindVertexArray(GLuint vao) {
+        getInstance()._bindVertexArray(vao);
+    }
+    
+    static void bindBuffer(GLenum target, GLuint buffer) {
+        getInstance()._bindBuffer(target, buffer);
+    }
+    
+    static void viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+        getInstance()._viewport(x, y, w, h);
+    }
+    
+    static void clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+        getInstance()._clearColor(r, g, b, a);
+    }
+    
+    static void enable(GLenum cap) {
+        getInstance()._setEnabled(cap, true);
+    }
+    
+    static void disable(GLenum cap) {
+        getInstance()._setEnabled(cap, false);
+    }
+    
+    static void depthFunc(GLenum func) {
+        getInstance()._depthFunc(func);
+    }
+    
+    static void cullFace(GLenum mode) {
+        getInstance()._cullFace(mode);
+    }
+    
+    static void frontFace(GLenum mode) {
+        getInstance()._frontFace(mode);
+    }
+    
+    static void forgetProgram(GLuint program) {
+        getInstance()._forgetProgram(program);
+    }
+    
+    static void forgetVertexArray(GLuint vao) {
+        getInstance()._forgetVertexArray(vao);
+    }
+    
+    static void forgetBuffer(GLuint buffer) {
+        getInstance()._forgetBuffer(buffer);
+    }
+    
+    static const GLStateCounter& counter(GLStateCall call) {
+        return getInstance().counters[call];
+    }
+    
+    static void resetCounters(void) {
+        getInstance()._resetCounters();
+    }
+    
+    /**
+     *  The counters as text, to show in a window title.
+     */
+    static std::string repr(void) {
+        return getInstance()._repr();
+    }
+};
+
+#endif /* GLState_hpp */
@@ -11,6 +11,7 @@
 #include "GLUtilities.hpp"
 #include "Matrices.hpp"
 #include "GLParams.hpp"
+#include "GLState.hpp"
 
 using namespace std;
 
@@ -40,11 +41,17 @@ GLFWwindow* GLUtilities::setupWindow(const int gl_viewport_w, const int gl_viewp
     
     glfwMakeContextCurrent(window);
     
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    /**
+     *  A new context starts with default state, so
+     *  nothing we remember from before applies.
+     */
+    GLState::invalidate();
+    
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_LESS);
+    GLState::enable(GL_CULL_FACE);
+    GLState::cullFace(GL_BACK);
+    GLState::frontFace(GL_CCW);
     
     return window;
 }
@@ -9,7 +9,7 @@
 #ifndef GLUtilities_hpp
 #define GLUtilities_hpp
 
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <string>
 #include "Matrix.hpp"
@@ -10,10 +10,27 @@
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include <cstring>
 
 using namespace std;
 
-Input::Input(void) {
+/**
+ *  Bump this if InputEvent changes.
+ */
+#define input_recording_magic 0x52504e49
+#define input_recording_version 1
+
+/**
+ *  What goes before the events in a recording.
+ */
+struct InputRecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t event_size;
+    uint32_t reserved;
+};
+
+Input::Input(void) : events(input_event_capacity), dropped(0) {
     mouseDown = nullptr;
     mouseUp = nullptr;
     mouseMove = nullptr;
@@ -21,14 +38,207 @@ Input::Input(void) {
     keyDown = nullptr;
     keyStrobe = nullptr;
     keyUp = nullptr;
+    current.px = 0.0f;
+    current.py = 0.0f;
+    current.pz = 0.0f;
+    memset(key_state, 0, sizeof(key_state));
+    memset(key_pressed, 0, sizeof(key_pressed));
     reset();
 }
 
-Input::~Input() {}
+Input::~Input() {
+    stopRecording();
+}
+
+void Input::push(const InputEvent &event) {
+    if(!events.push(event)) {
+        dropped.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void Input::glfwMouseButtonCallback(GLFWwindow *window, int button, int action, int mods) {
+    InputEvent event = {};
+    event.time = glfwGetTime();
+    event.type = INPUT_MOUSE_BUTTON;
+    event.code = (int16_t)button;
+    event.action = (uint8_t)action;
+    event.mods = (uint8_t)mods;
+    getInstance().push(event);
+}
+
+void Input::glfwMouseMoveCallback(GLFWwindow *window, double x_pos, double y_pos) {
+    InputEvent event = {};
+    event.time = glfwGetTime();
+    event.type = INPUT_MOUSE_MOVE;
+    event.x = (float)x_pos;
+    event.y = (float)y_pos;
+    getInstance().push(event);
+}
+
+void Input::glfwKeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    InputEvent event = {};
+    event.time = glfwGetTime();
+    event.type = INPUT_KEY;
+    event.code = (int16_t)key;
+    event.scancode = (int16_t)scancode;
+    event.action = (uint8_t)action;
+    event.mods = (uint8_t)mods;
+    getInstance().push(event);
+}
 
-Input::Input(Input const&) {}
+bool Input::startRecording(const string &path) {
+    stopRecording();
+    
+    recording.open(path, ios::out | ios::binary | ios::trunc);
+    if(!recording.is_open()) {
+        cerr << "Could not record input to: " << path << endl;
+        return false;
+    }
+    
+    InputRecordingHeader header = {input_recording_magic, input_recording_version, (uint32_t)sizeof(InputEvent), 0};
+    recording.write((const char *)&header, sizeof(header));
+    return true;
+}
 
-void Input::operator=(Input const&) {}
+void Input::stopRecording(void) {
+    if(recording.is_open()) {
+        recording.close();
+    }
+}
+
+bool Input::startReplay(const string &path) {
+    ifstream file(path, ios::in | ios::binary);
+    if(!file.is_open()) {
+        cerr << "Could not open the input recording: " << path << endl;
+        return false;
+    }
+    
+    InputRecordingHeader header;
+    if(!file.read((char *)&header, sizeof(header)) ||
+       input_recording_magic != header.magic ||
+       input_recording_version != header.version ||
+       sizeof(InputEvent) != header.event_size) {
+        cerr << "Not an input recording this build can play: " << path << endl;
+        return false;
+    }
+    
+    replay_events.clear();
+    InputEvent event;
+    while(file.read((char *)&event, sizeof(event))) {
+        replay_events.push_back(event);
+    }
+    
+    replay_next = 0;
+    replaying_input = !replay_events.empty();
+    return replaying_input;
+}
+
+void Input::record(void) {
+    if(!recording.is_open()) {
+        return;
+    }
+    
+    InputEvent frame = {};
+    frame.time = frame_time;
+    frame.type = INPUT_FRAME;
+    recording.write((const char *)&frame, sizeof(frame));
+    if(!frame_events.empty()) {
+        recording.write((const char *)&frame_events[0], frame_events.size() * sizeof(InputEvent));
+    }
+}
+
+/**
+ *  Swaps this frame's real events for the recorded ones,
+ *  up to the next frame marker.
+ */
+void Input::nextReplayFrame(void) {
+    frame_events.clear();
+    
+    /**
+     *  Keys held at the end of the recording
+     *  aren't held for real, so let them go.
+     */
+    if(replay_next >= replay_events.size()) {
+        replaying_input = false;
+        frame_time = glfwGetTime();
+        memset(key_state, 0, sizeof(key_state));
+        return;
+    }
+    
+    frame_time = replay_events[replay_next++].time;
+    while(replay_next < replay_events.size() && INPUT_FRAME != replay_events[replay_next].type) {
+        frame_events.push_back(replay_events[replay_next++]);
+    }
+}
+
+/**
+ *  Events come off the ring in one go, then each is
+ *  applied in the order it happened.
+ */
+void Input::dispatch(void) {
+    memset(key_pressed, 0, sizeof(key_pressed));
+    
+    frame_events.resize(events.capacity());
+    frame_events.resize(events.pop(&frame_events[0], frame_events.size()));
+    
+    if(replaying_input) {
+        nextReplayFrame();
+    }
+    else {
+        frame_time = glfwGetTime();
+    }
+    record();
+    
+    for(const InputEvent &event: frame_events) {
+        switch(event.type) {
+            case INPUT_KEY:
+                setKey(event.code, event.action);
+                keyCallback(event.code, event.scancode, event.action, event.mods);
+                break;
+            case INPUT_MOUSE_BUTTON:
+                mouseButtonCallback(event.code, event.action, event.mods);
+                break;
+            case INPUT_MOUSE_MOVE:
+                mouseMoveCallback(event.x, event.y);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ *  GLFW_KEY_UNKNOWN is -1, so anything out
+ *  of range is left out of the bits.
+ */
+void Input::setKey(int key, int action) {
+    if(key < 0 || key > GLFW_KEY_LAST) {
+        return;
+    }
+    
+    const uint64_t bit = (uint64_t)1 << (key & 63);
+    if(GLFW_PRESS == action) {
+        key_state[key >> 6] |= bit;
+        key_pressed[key >> 6] |= bit;
+    }
+    else if(GLFW_RELEASE == action) {
+        key_state[key >> 6] &= ~bit;
+    }
+}
+
+bool Input::isKeyDown(int key) const {
+    if(key < 0 || key > GLFW_KEY_LAST) {
+        return false;
+    }
+    return (key_state[key >> 6] >> (key & 63)) & 1;
+}
+
+bool Input::wasKeyPressed(int key) const {
+    if(key < 0 || key > GLFW_KEY_LAST) {
+        return false;
+    }
+    return (key_pressed[key >> 6] >> (key & 63)) & 1;
+}
 
 void Input::mouseButtonCallback(int button, int action, int mods) {
     /**
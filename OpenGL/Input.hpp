@@ -9,13 +9,57 @@
 #ifndef Input_hpp
 #define Input_hpp
 
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <string>
 #include <iostream>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
 #include "Structs.h"
+#include "RingBuffer.hpp"
 
 #define one_deg_in_rad (2.0 * M_PI) / 360.0f
 
+/**
+ *  Room for this many events between two calls to dispatch.
+ */
+#define input_event_capacity 1024
+
+/**
+ *  Enough 64 bit words for one bit per GLFW key.
+ */
+#define input_key_words ((GLFW_KEY_LAST + 64) / 64)
+
+enum InputEventType {
+    INPUT_KEY,
+    INPUT_MOUSE_BUTTON,
+    INPUT_MOUSE_MOVE,
+    INPUT_FRAME
+};
+
+/**
+ *  One thing GLFW told us about, and when (glfwGetTime).
+ *
+ *  -   Keys use code, scancode, action and mods.
+ *  -   Mouse buttons use code (the button), action and mods.
+ *  -   Mouse moves use x and y.
+ *  -   Frames only show up in recordings, one before the events
+ *      of each dispatch, with the time of that dispatch.
+ */
+struct InputEvent {
+    double time;
+    float x;
+    float y;
+    int16_t code;
+    int16_t scancode;
+    uint8_t type;
+    uint8_t action;
+    uint8_t mods;
+};
+
 class Input {
     
 private:
@@ -27,6 +71,37 @@ private:
     ~Input();
     void operator=(Input const&);
     
+    /**
+     *  The GLFW callbacks only push on to events. Everything
+     *  else happens in dispatch, on whichever thread calls it.
+     */
+    RingBuffer<InputEvent> events;
+    std::vector<InputEvent> frame_events;
+    std::atomic<size_t> dropped;
+    
+    /**
+     *  One bit per key, for keys held down and
+     *  keys pressed since the last dispatch.
+     */
+    uint64_t key_state[input_key_words];
+    uint64_t key_pressed[input_key_words];
+    
+    /**
+     *  Time of the last dispatch, which is
+     *  the recorded one while replaying.
+     */
+    double frame_time = 0.0;
+    
+    std::ofstream recording;
+    std::vector<InputEvent> replay_events;
+    size_t replay_next = 0;
+    bool replaying_input = false;
+    
+    void push(const InputEvent &event);
+    void setKey(int key, int action);
+    void record(void);
+    void nextReplayFrame(void);
+    
     /**
      *  Member variables
      */
@@ -65,6 +140,70 @@ public:
     void updateDistanceAndAngle(void);
     void reset(void);
     
+    /**
+     *  Takes everything the callbacks have queued since last
+     *  time, updates the key state and mouse position and fires
+     *  the std::function callbacks. Call once a frame after
+     *  glfwPollEvents, from one thread only.
+     */
+    void dispatch(void);
+    
+    /**
+     *  The time (glfwGetTime) of the last dispatch. Anything that
+     *  moves with time should use this rather than the clock, so
+     *  a replay moves it exactly as it did when it was recorded.
+     */
+    double time(void) const {
+        return frame_time;
+    }
+    
+    /**
+     *  Writes every dispatch from now on to a file: a frame marker
+     *  then the events it took, as raw InputEvents after a small
+     *  header. Returns false if the file can't be opened.
+     */
+    bool startRecording(const std::string &path);
+    void stopRecording(void);
+    
+    /**
+     *  Loads a recording and plays it back one frame per dispatch,
+     *  ignoring real input until it runs out. Returns false if the
+     *  file is missing or was written by a different build.
+     */
+    bool startReplay(const std::string &path);
+    
+    bool replaying(void) const {
+        return replaying_input;
+    }
+    
+    /**
+     *  The events taken by the last dispatch, oldest first.
+     */
+    const std::vector<InputEvent>& frameEvents(void) const {
+        return frame_events;
+    }
+    
+    /**
+     *  Whether the key was down as of the last dispatch, and
+     *  whether it went down during it (for keys that toggle).
+     */
+    bool isKeyDown(int key) const;
+    bool wasKeyPressed(int key) const;
+    
+    /**
+     *  Events thrown away because the ring was full.
+     */
+    size_t droppedEvents(void) const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     *  Where the mouse pointer was last seen.
+     */
+    Position position(void) const {
+        return current;
+    }
+    
     /**
      *  Assigning an std::function callback for the mouse 
      *  button press.
@@ -118,31 +257,19 @@ public:
     }
     
     /**
-     *  Static function passed in to GLFW and called when a mouse button is pressed/released.
-     */
-    static void glfwMouseButtonCallback(GLFWwindow *window, int button, int action, int mods) {
-        getInstance().mouseButtonCallback(button, action, mods);
-    }
-    
-    /**
-     *  Static function passed in to GLFW and called when the mouse is moved.
+     *  Static functions passed in to GLFW. They only queue
+     *  an event, which is handled on the next dispatch.
      */
-    static void glfwMouseMoveCallback(GLFWwindow *window, double x_pos, double y_pos) {
-        getInstance().mouseMoveCallback(x_pos, y_pos);
-    }
-    
-    /**
-     *  Static function passed in to GLFW and called on keyboard key press/release.
-     */
-    static void glfwKeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods) {
-        getInstance().keyCallback(key, scancode, action, mods);
-    }
+    static void glfwMouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
+    static void glfwMouseMoveCallback(GLFWwindow *window, double x_pos, double y_pos);
+    static void glfwKeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
     
     static void glfwKeyCharCallback(GLFWwindow *window, unsigned int codepoint) {
     }
     
     /**
-     *  Member functions of the instance of the class. 
+     *  Member functions of the instance of the class, run
+     *  by dispatch for each event.
      *
      *  These will fire the std::function callbacks by checking
      *  the input parameters and calling the correct callbacks
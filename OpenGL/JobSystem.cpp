@@ -0,0 +1,228 @@
+//
+//  JobSystem.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 24/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+/**
+ *  Which queue the current thread pushes to and pops from,
+ *  for each job system it is a worker of.
+ */
+static thread_local const JobSystem *current_system = nullptr;
+static thread_local int current_queue = -1;
+
+JobCounter::JobCounter() : value(0) {}
+
+int JobCounter::get(void) const {
+    return value.load();
+}
+
+JobSystem::JobSystem(int workers) : running(true), pending(0) {
+    if(workers < 0) {
+#if defined(OPENGL_SINGLE_THREADED)
+        workers = 0;
+#else
+        workers = max(0, (int)thread::hardware_concurrency() - 1);
+#endif
+    }
+    
+    for(int i = 0; i <= workers; i++) {
+        queues.emplace_back(new Queue());
+    }
+    
+    threads.reserve(workers);
+    for(int i = 0; i < workers; i++) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    running = false;
+    {
+        lock_guard<mutex> guard(sleep_lock);
+    }
+    wake.notify_all();
+    
+    for(auto &t: threads) {
+        t.join();
+    }
+}
+
+int JobSystem::workerCount(void) const {
+    return (int)threads.size();
+}
+
+int JobSystem::queueIndex(void) const {
+    return current_system == this ? current_queue : (int)threads.size();
+}
+
+void JobSystem::push(const JobTask &task) {
+    Queue &queue = *queues[queueIndex()];
+    {
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(task);
+    }
+    pending++;
+    
+    if(!threads.empty()) {
+        /**
+         *  Taking the lock makes sure a worker that has just
+         *  found nothing to do is already waiting, and will
+         *  not miss being woken up.
+         */
+        {
+            lock_guard<mutex> guard(sleep_lock);
+        }
+        wake.notify_one();
+    }
+}
+
+/**
+ *  Newest first from our own queue, which is likely still
+ *  in the cache, then oldest first from everybody else's.
+ */
+bool JobSystem::pop(JobTask &task) {
+    const int own = queueIndex();
+    const int count = (int)queues.size();
+    
+    for(int i = 0; i < count; i++) {
+        int index = (own + i) % count;
+        Queue &queue = *queues[index];
+        lock_guard<mutex> guard(queue.lock);
+        
+        if(queue.tasks.empty()) {
+            continue;
+        }
+        
+        if(index == own) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        else {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        pending--;
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::execute(JobTask &task) {
+    task.work();
+    if(task.counter) {
+        finish(task.counter);
+    }
+}
+
+/**
+ *  The counter is only touched while holding its lock, so
+ *  once wait has taken the lock after seeing zero it knows
+ *  nobody is still using the counter and it can go away.
+ */
+void JobSystem::finish(JobCounter *counter) {
+    vector<JobTask> released;
+    {
+        lock_guard<mutex> guard(counter->lock);
+        if(--counter->value == 0) {
+            released.swap(counter->waiting);
+        }
+    }
+    
+    for(auto &task: released) {
+        push(task);
+    }
+}
+
+void JobSystem::workerLoop(int index) {
+    current_system = this;
+    current_queue = index;
+    
+    JobTask task;
+    while(running) {
+        if(pop(task)) {
+            execute(task);
+            continue;
+        }
+        
+        unique_lock<mutex> guard(sleep_lock);
+        wake.wait(guard, [this] {
+            return pending > 0 || !running;
+        });
+    }
+}
+
+void JobSystem::run(const Job &job, JobCounter *counter, JobCounter *after) {
+    JobTask task;
+    task.work = job;
+    task.counter = counter;
+    
+    if(counter) {
+        counter->value++;
+    }
+    
+    if(after) {
+        lock_guard<mutex> guard(after->lock);
+        if(after->value > 0) {
+            after->waiting.push_back(task);
+            return;
+        }
+    }
+    
+    push(task);
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    JobTask task;
+    while(counter.value > 0) {
+        if(pop(task)) {
+            execute(task);
+        }
+        else if(threads.empty()) {
+            cerr << "JobSystem: waiting on a counter that no queued job will finish." << endl;
+            break;
+        }
+        else {
+            this_thread::yield();
+        }
+    }
+    
+    lock_guard<mutex> guard(counter.lock);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const function<void(size_t, size_t)> &body) {
+    if(count == 0) {
+        return;
+    }
+    
+    /**
+     *  A few ranges per thread evens things
+     *  out when some ranges take longer.
+     */
+    if(grain == 0) {
+        size_t ranges = (threads.size() + 1) * 4;
+        grain = max((size_t)1, (count + ranges - 1) / ranges);
+    }
+    
+    if(count <= grain) {
+        body(0, count);
+        return;
+    }
+    
+    JobCounter counter;
+    for(size_t begin = 0; begin < count; begin += grain) {
+        size_t end = min(count, begin + grain);
+        run([&body, begin, end] {
+            body(begin, end);
+        }, &counter);
+    }
+    wait(counter);
+}
@@ -0,0 +1,125 @@
+//
+//  JobSystem.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 24/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef JobSystem_hpp
+#define JobSystem_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  Uses every hardware thread, counting the one that
+ *  waits on jobs, unless built with OPENGL_SINGLE_THREADED.
+ */
+const int default_job_workers = -1;
+
+typedef std::function<void()> Job;
+
+class JobCounter;
+
+struct JobTask {
+    Job work;
+    JobCounter *counter;
+};
+
+/**
+ *  Counts the jobs that still have to finish. A job can be
+ *  told to wait for a counter to reach zero before it runs,
+ *  which is how jobs depend on each other.
+ */
+class JobCounter {
+    
+    friend class JobSystem;
+
+private:
+    std::atomic<int> value;
+    std::mutex lock;
+    std::vector<JobTask> waiting;
+    
+    JobCounter(const JobCounter &);
+    void operator=(const JobCounter &);
+
+public:
+    JobCounter();
+    int get(void) const;
+};
+
+/**
+ *  A pool of worker threads that each have their own queue
+ *  of jobs. Workers take the newest job from their own queue
+ *  and, when that runs dry, steal the oldest job from someone
+ *  else's, so busy workers share out their work.
+ *
+ *  With no workers every job runs on the thread that calls
+ *  wait, in the same order every time, for debugging.
+ */
+class JobSystem {
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<JobTask> tasks;
+    };
+    
+    /**
+     *  One queue per worker, plus one at the end
+     *  for threads that are not part of the pool.
+     */
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    
+    std::atomic<bool> running;
+    std::atomic<int> pending;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    
+    JobSystem(const JobSystem &);
+    void operator=(const JobSystem &);
+    
+    int queueIndex(void) const;
+    void push(const JobTask &task);
+    bool pop(JobTask &task);
+    void execute(JobTask &task);
+    void finish(JobCounter *counter);
+    void workerLoop(int index);
+
+public:
+    explicit JobSystem(int workers = default_job_workers);
+    ~JobSystem();
+    
+    int workerCount(void) const;
+    
+    /**
+     *  Queues a job. If counter is given it goes up by one
+     *  now and down by one when the job is done. If after is
+     *  given, the job does not start until after reaches zero.
+     */
+    void run(const Job &job, JobCounter *counter = nullptr, JobCounter *after = nullptr);
+    
+    /**
+     *  Runs queued jobs on this thread until the counter
+     *  reaches zero, so waiting never wastes a thread.
+     */
+    void wait(JobCounter &counter);
+    
+    /**
+     *  Splits 0 to count in to ranges of about grain items,
+     *  calls body(begin, end) for each as a job and waits for
+     *  them all. A grain of 0 picks one from the worker count.
+     */
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body);
+};
+
+#endif /* JobSystem_hpp */
@@ -0,0 +1,122 @@
+//
+//  LockFreeQueue.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 30/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef LockFreeQueue_hpp
+#define LockFreeQueue_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ *  A fixed size queue any number of threads can push to
+ *  and pop from without taking a lock. Each cell has a
+ *  sequence number that says whether it is ready to be
+ *  written or read on this trip round the ring, so a thread
+ *  only has to win one compare and swap on the head or tail
+ *  to own a cell.
+ *
+ *  The capacity is rounded up to a power of two.
+ */
+template<typename T>
+class LockFreeQueue {
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    
+    /**
+     *  Kept on their own cache lines so pushing
+     *  and popping threads don't fight over one.
+     */
+    alignas(64) std::atomic<size_t> tail;
+    alignas(64) std::atomic<size_t> head;
+    
+    LockFreeQueue(const LockFreeQueue &);
+    void operator=(const LockFreeQueue &);
+
+public:
+    explicit LockFreeQueue(size_t capacity) : tail(0), head(0) {
+        size_t size = 2;
+        while(size < capacity) {
+            size <<= 1;
+        }
+        
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for(size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    /**
+     *  Returns false, leaving value alone, if the queue is full.
+     */
+    bool push(T &value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        
+        for(;;) {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+            
+            if(diff == 0) {
+                if(tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0) {
+                return false;
+            }
+            else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    /**
+     *  Returns false if the queue is empty.
+     */
+    bool pop(T &value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        
+        for(;;) {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(position + 1);
+            
+            if(diff == 0) {
+                if(head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0) {
+                return false;
+            }
+            else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    size_t capacity(void) const {
+        return mask + 1;
+    }
+};
+
+#endif /* LockFreeQueue_hpp */
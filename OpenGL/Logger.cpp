@@ -8,86 +8,326 @@
 
 #include "Logger.hpp"
 #include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <chrono>
 #include <ctime>
+#include <cstdlib>
+#include <cstring>
 #include <stdarg.h>
-#include <cstdio>
-#include <fstream>
+#include <sys/stat.h>
 
 using namespace std;
 
-Logger::Logger(){};
-Logger::~Logger(){};
+/**
+ *  How many messages can wait to be written.
+ */
+#define log_queue_size 4096
 
 /**
- *  Use this to create a path name based on
- *  the time and the date.
+ *  The writer wakes this often, or sooner once
+ *  this many messages (or any error) are waiting.
  */
-string Logger::logFilePath(bool is_error) const {
-    auto t = std::time(nullptr);
-    auto tm = *std::localtime(&t);
-    ostringstream oss;
-    oss << put_time(&tm, "%d-%m-%Y");
-    auto str = oss.str();
-    return "/Users/matfin/OpenGL/" + str + ( is_error ? ".err":".log");
+#define log_flush_interval_ms 100
+#define log_batch_records 256
+
+#define log_default_directory "logs"
+#define log_default_max_file_size (8 * 1024 * 1024)
+
+/**
+ *  Rotated files kept, as .1 to .n.
+ */
+#define log_rotate_keep 3
+
+enum LogFile {
+    LOG_FILE_MESSAGES,
+    LOG_FILE_ERRORS
 };
 
-void Logger::write(const char *message, ...) {
-    auto path = logFilePath(false);
-    va_list argptr;
+LogWriter::LogWriter() :
+    records(log_queue_size),
+    pending(0),
+    dropped(0),
+    stopped(false),
+    level(log_level_debug),
+    directory(log_default_directory),
+    max_file_size(log_default_max_file_size) {
     
-    /**
-     *  Create the log file for writing and appending
-     */
-    try {
-        FILE *file = fopen(path.c_str(), "a");
-        if(file) {
-            va_start(argptr, message);
-            vfprintf(file, message, argptr);
-            va_end(argptr);
-            fclose(file);
+    for(int i = 0; i < 2; i++) {
+        files[i] = nullptr;
+        file_sizes[i] = 0;
+    }
+    
+#if !defined(OPENGL_SINGLE_THREADED)
+    thread = std::thread(&LogWriter::worker, this);
+#endif
+}
+
+/**
+ *  Called once at exit. The writer itself is never destroyed,
+ *  so anything that logs after this (like the destructor of a
+ *  static made before the first message) still has somewhere
+ *  to log to, and from then on each message is written as it
+ *  comes in.
+ */
+void LogWriter::_shutdown(void) {
+    {
+        lock_guard<mutex> guard(wake_lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    
+    if(thread.joinable()) {
+        thread.join();
+    }
+    stopped.store(true, memory_order_release);
+    
+    writeBatch();
+}
+
+static void log_writer_exit(void) {
+    LogWriter::shutdown();
+}
+
+/**
+ *  Made on first use and never freed, as statics are torn down
+ *  in reverse order of being made and a static made before the
+ *  first message could otherwise log to a writer that has gone.
+ */
+LogWriter& LogWriter::getInstance() {
+    static LogWriter *instance = []() {
+        LogWriter *writer = new LogWriter();
+        atexit(log_writer_exit);
+        return writer;
+    }();
+    return *instance;
+}
+
+/**
+ *  Nothing is locked here unless the writer needs a nudge. A
+ *  nudge can be missed if the writer is just going to sleep,
+ *  but then it only waits until the next interval.
+ */
+void LogWriter::_push(LogRecord &record) {
+    const bool is_error = record.is_error;
+    
+    if(!records.push(record)) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    
+    if(stopped.load(memory_order_acquire)) {
+        writeBatch();
+        return;
+    }
+    
+    size_t waiting = pending.fetch_add(1, memory_order_relaxed) + 1;
+    if(is_error || waiting >= log_batch_records) {
+#if defined(OPENGL_SINGLE_THREADED)
+        writeBatch();
+#else
+        wake.notify_one();
+#endif
+    }
+}
+
+/**
+ *  Goes straight round again if a full batch
+ *  built up while the last one was being written.
+ */
+void LogWriter::worker(void) {
+    unique_lock<mutex> lock(wake_lock);
+    
+    while(!stopping) {
+        wake.wait_for(lock, chrono::milliseconds(log_flush_interval_ms), [this]() {
+            return stopping || pending.load(memory_order_relaxed) >= log_batch_records;
+        });
+        
+        lock.unlock();
+        writeBatch();
+        lock.lock();
+    }
+}
+
+/**
+ *  Takes everything off the queue, sorts it in to messages and
+ *  errors, and writes each with a single call.
+ */
+void LogWriter::writeBatch(void) {
+    lock_guard<mutex> guard(write_lock);
+    
+    LogRecord record;
+    size_t count = 0;
+    while(records.pop(record)) {
+        batch[record.is_error ? LOG_FILE_ERRORS : LOG_FILE_MESSAGES].append(record.text, record.length);
+        count++;
+    }
+    pending.fetch_sub(count, memory_order_relaxed);
+    
+    size_t total_drops = dropped.load(memory_order_relaxed);
+    size_t lost = total_drops - reported_drops;
+    reported_drops = total_drops;
+    if(lost) {
+        batch[LOG_FILE_ERRORS] += to_string(lost) + " log messages were dropped.\n";
+    }
+    
+    if(!batch[LOG_FILE_ERRORS].empty()) {
+        fputs(batch[LOG_FILE_ERRORS].c_str(), stderr);
+    }
+    
+    for(int which = 0; which < 2; which++) {
+        writeFile(which, batch[which]);
+        batch[which].clear();
+    }
+}
+
+void LogWriter::writeFile(int which, const string &text) {
+    if(text.empty()) {
+        return;
+    }
+    
+    FILE *&file = files[which];
+    if(!file) {
+        mkdir(directory.c_str(), 0755);
+        file = fopen(path(which, 0).c_str(), "a");
+        if(!file) {
+            cerr << "Could not open file for writing: " << path(which, 0) << endl;
+            return;
         }
-        else {
-            throw runtime_error("Could not open file for writing: " + path);
+        fseek(file, 0, SEEK_END);
+        file_sizes[which] = (size_t)ftell(file);
+    }
+    
+    fwrite(text.data(), 1, text.size(), file);
+    fflush(file);
+    file_sizes[which] += text.size();
+    
+    if(max_file_size && file_sizes[which] >= max_file_size) {
+        rotate(which);
+    }
+}
+
+/**
+ *  Shuffles the older files along one,
+ *  losing the oldest, then starts afresh.
+ */
+void LogWriter::rotate(int which) {
+    fclose(files[which]);
+    files[which] = nullptr;
+    file_sizes[which] = 0;
+    
+    for(int generation = log_rotate_keep - 1; generation >= 0; generation--) {
+        rename(path(which, generation).c_str(), path(which, generation + 1).c_str());
+    }
+}
+
+void LogWriter::close(void) {
+    for(int which = 0; which < 2; which++) {
+        if(files[which]) {
+            fclose(files[which]);
+            files[which] = nullptr;
         }
     }
-    catch(exception &e) {
-        cout << e.what() << endl;
+}
+
+/**
+ *  Named after the date the file was opened,
+ *  with the generation on the end once rotated.
+ */
+string LogWriter::path(int which, int generation) {
+    time_t t = time(nullptr);
+    tm local;
+    localtime_r(&t, &local);
+    
+    char date[16];
+    strftime(date, sizeof(date), "%d-%m-%Y", &local);
+    
+    string name = directory + "/" + date + (LOG_FILE_ERRORS == which ? ".err" : ".log");
+    if(generation > 0) {
+        name += "." + to_string(generation);
+    }
+    return name;
+}
+
+void LogWriter::_flush(void) {
+    writeBatch();
+}
+
+void LogWriter::_setDirectory(const string &path) {
+    lock_guard<mutex> guard(write_lock);
+    close();
+    directory = path;
+}
+
+void LogWriter::_setMaxFileSize(size_t bytes) {
+    lock_guard<mutex> guard(write_lock);
+    max_file_size = bytes;
+}
+
+void LogWriter::_setLevel(int _level) {
+    level.store(_level, memory_order_relaxed);
+}
+
+size_t LogWriter::_droppedCount(void) {
+    return dropped.load(memory_order_relaxed);
+}
+
+Logger::Logger() {}
+Logger::~Logger() {}
+
+/**
+ *  Formats in to a record on the caller's stack, which
+ *  push then copies on to the queue. Nothing is allocated.
+ */
+static void log_format(LogRecord &record, bool is_error, const char *message, va_list args) {
+    int length = vsnprintf(record.text, sizeof(record.text), message, args);
+    if(length < 0) {
+        length = 0;
     }
+    record.length = (uint16_t)min(length, (int)sizeof(record.text) - 1);
+    record.is_error = is_error;
+}
+
+void Logger::write(const char *message, ...) {
+    LogRecord record;
+    va_list args;
+    va_start(args, message);
+    log_format(record, false, message, args);
+    va_end(args);
+    LogWriter::push(record);
 }
 
 void Logger::write_err(const char *message, ...) {
+    LogRecord record;
+    va_list args;
+    va_start(args, message);
+    log_format(record, true, message, args);
+    va_end(args);
+    LogWriter::push(record);
+}
+
+void Logger::log(int level, const char *message, ...) {
+    static const char *prefixes[] = {"DEBUG: ", "INFO: ", "WARN: ", "ERROR: "};
+    const char *prefix = prefixes[min(max(level, (int)log_level_debug), (int)log_level_error)];
     
-    auto path = logFilePath(true);
-    va_list argptr;
+    LogRecord record;
+    size_t prefix_length = strlen(prefix);
+    memcpy(record.text, prefix, prefix_length);
     
     /**
-     *  Create the log file for writing and appending
+     *  One byte is kept back for the new line.
      */
-    try {
-        FILE *file = fopen(path.c_str(), "a");
-        if(file) {
-            /**
-             *  Write to the console.
-             */
-            va_start(argptr, message);
-            vfprintf(stderr, message, argptr);
-            va_end(argptr);
-            
-            /**
-             *  Then to the file
-             */
-            va_start(argptr, message);
-            vfprintf(file, message, argptr);
-            va_end(argptr);
-            fclose(file);
-        }
-        else {
-            throw runtime_error("Could not open file for writing: " + path);
-        }
-    }
-    catch(exception &e) {
-        cout << e.what() << endl;
+    va_list args;
+    va_start(args, message);
+    int length = vsnprintf(record.text + prefix_length, sizeof(record.text) - prefix_length - 1, message, args);
+    va_end(args);
+    
+    if(length < 0) {
+        length = 0;
     }
+    size_t end = min(prefix_length + length, sizeof(record.text) - 2);
+    record.text[end] = '\n';
+    record.text[end + 1] = '\0';
+    record.length = (uint16_t)(end + 1);
+    record.is_error = level >= log_level_warn;
+    LogWriter::push(record);
 }
@@ -10,15 +10,233 @@
 #define Logger_hpp
 
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include "LockFreeQueue.hpp"
 
+/**
+ *  Messages longer than this are cut short.
+ */
+#define log_record_size 256
+
+/**
+ *  How much a message matters, least first.
+ */
+#define log_level_debug 0
+#define log_level_info 1
+#define log_level_warn 2
+#define log_level_error 3
+#define log_level_off 4
+
+/**
+ *  Messages below this level are compiled out altogether. CMake
+ *  sets it from OPENGL_LOG_LEVEL; left alone, debug messages are
+ *  only built in to builds without NDEBUG.
+ */
+#if !defined(OPENGL_LOG_LEVEL)
+#if defined(NDEBUG)
+#define OPENGL_LOG_LEVEL log_level_info
+#else
+#define OPENGL_LOG_LEVEL log_level_debug
+#endif
+#endif
+
+/**
+ *  One formatted message waiting to be written.
+ */
+struct LogRecord {
+    uint16_t length;
+    bool is_error;
+    char text[log_record_size];
+};
+
+/**
+ *  Writes log records out on a background thread. Each message is
+ *  formatted in to a fixed size record and copied on to a queue that
+ *  was all allocated up front, and the thread writes whatever has
+ *  built up in one go with the files left open, so logging from a
+ *  busy loop never waits on the disk.
+ *
+ *  Messages go to <directory>/<dd-mm-yyyy>.log, and errors to
+ *  .err (and stderr). A file that grows past the size limit is
+ *  moved to .1 (and .1 to .2 and so on) and a new one started.
+ *
+ *  If the queue is full the message is dropped and counted, and
+ *  the count is written with the next batch. Built with
+ *  OPENGL_SINGLE_THREADED there is no thread, and batches are
+ *  written by whoever logs once enough have built up.
+ *
+ *  The writer lives until the process ends, so logging is safe
+ *  from anywhere, static destructors included. The thread stops
+ *  at exit and anything logged after that is written straight
+ *  away by whoever logs it.
+ */
+class LogWriter {
+
+private:
+    LogWriter();
+    ~LogWriter() {};
+    LogWriter(LogWriter const &);
+    void operator=(LogWriter const &);
+    static LogWriter& getInstance();
+    
+    LockFreeQueue<LogRecord> records;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> dropped;
+    std::atomic<int> level;
+    
+    /**
+     *  Set once the thread has finished at exit.
+     */
+    std::atomic<bool> stopped;
+    
+    /**
+     *  Only touched while holding write_lock.
+     */
+    std::mutex write_lock;
+    std::string directory;
+    size_t max_file_size;
+    size_t reported_drops = 0;
+    FILE *files[2];
+    size_t file_sizes[2];
+    std::string batch[2];
+    
+    std::thread thread;
+    std::mutex wake_lock;
+    std::condition_variable wake;
+    bool stopping = false;
+    
+    void worker(void);
+    void writeBatch(void);
+    void writeFile(int which, const std::string &text);
+    void close(void);
+    void rotate(int which);
+    std::string path(int which, int generation);
+    
+    void _push(LogRecord &record);
+    void _shutdown(void);
+    void _flush(void);
+    void _setDirectory(const std::string &path);
+    void _setMaxFileSize(size_t bytes);
+    size_t _droppedCount(void);
+    void _setLevel(int _level);
+    bool _isEnabled(int _level) const {
+        return _level >= level.load(std::memory_order_relaxed);
+    }
+
+public:
+    static void push(LogRecord &record) {
+        getInstance()._push(record);
+    }
+    
+    /**
+     *  Stops the thread and writes out what is waiting.
+     *  Registered with atexit, so there is no need to call it.
+     */
+    static void shutdown(void) {
+        getInstance()._shutdown();
+    }
+    
+    /**
+     *  Writes everything queued so far before returning.
+     */
+    static void flush(void) {
+        getInstance()._flush();
+    }
+    
+    /**
+     *  Where log files go, "logs" in the working directory
+     *  unless set, as relative paths are. Takes effect from the
+     *  next file opened, so set it before logging anything.
+     */
+    static void setDirectory(const std::string &path) {
+        getInstance()._setDirectory(path);
+    }
+    
+    /**
+     *  0 turns rotation off.
+     */
+    static void setMaxFileSize(size_t bytes) {
+        getInstance()._setMaxFileSize(bytes);
+    }
+    
+    /**
+     *  Messages dropped since the start.
+     */
+    static size_t droppedCount(void) {
+        return getInstance()._droppedCount();
+    }
+    
+    /**
+     *  Messages below this level are skipped (before
+     *  they are formatted) from now on. Anything below
+     *  OPENGL_LOG_LEVEL is never built in anyway.
+     */
+    static void setLevel(int _level) {
+        getInstance()._setLevel(_level);
+    }
+    
+    static bool isEnabled(int _level) {
+        return getInstance()._isEnabled(_level);
+    }
+};
+
+/**
+ *  printf style logging. Any number of these can be made and used
+ *  from any thread, as they all hand their messages to LogWriter.
+ */
 class Logger {
 public:
     Logger();
     ~Logger();
     void write(const char *message, ...);
     void write_err(const char *message, ...);
-private:
-    std::string logFilePath(bool is_error) const;
+    
+    /**
+     *  What the LOG_ macros call. Warnings and errors go
+     *  to the error file, the rest to the message file.
+     */
+    static void log(int level, const char *message, ...);
 };
 
+/**
+ *  LOG_DEBUG("Loaded %d meshes", count) and so on. A level below
+ *  OPENGL_LOG_LEVEL expands to nothing, arguments and all, and one
+ *  below the runtime level costs a check and is never formatted.
+ */
+#define LOG_AT(log_level, ...) \
+    do { \
+        if(LogWriter::isEnabled(log_level)) { \
+            Logger::log(log_level, __VA_ARGS__); \
+        } \
+    } while(0)
+
+#if OPENGL_LOG_LEVEL <= log_level_debug
+#define LOG_DEBUG(...) LOG_AT(log_level_debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while(0)
+#endif
+
+#if OPENGL_LOG_LEVEL <= log_level_info
+#define LOG_INFO(...) LOG_AT(log_level_info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while(0)
+#endif
+
+#if OPENGL_LOG_LEVEL <= log_level_warn
+#define LOG_WARN(...) LOG_AT(log_level_warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while(0)
+#endif
+
+#if OPENGL_LOG_LEVEL <= log_level_error
+#define LOG_ERROR(...) LOG_AT(log_level_error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while(0)
+#endif
+
 #endif /* Logger_hpp */
@@ -9,7 +9,7 @@
 #ifndef Matrix_hpp
 #define Matrix_hpp
 
-#include <GLFW/glfw3.h>
+#include "GLPlatform.h"
 #include <string>
 #include <sstream>
 #include <vector>
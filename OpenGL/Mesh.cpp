@@ -7,56 +7,89 @@
 //
 
 #include "Mesh.hpp"
+#include "MeshBuffers.hpp"
+#include "Logger.hpp"
 
 using namespace std;
 
-Mesh::Mesh(){}
+Mesh::Mesh() {
+    computeBounds();
+}
 
 Mesh::Mesh(std::vector<Point> _points, std::vector<Colour> _colours) : points(_points), colours(_colours) {
-    cout << "Construct: Mesh" << endl;
+    LOG_DEBUG("Construct: Mesh");
+    computeBounds();
 }
 
 Mesh::~Mesh() {
-    cout << "Destruct: Mesh" << endl;
+    LOG_DEBUG("Destruct: Mesh");
+}
+
+Mesh::Mesh(const Mesh &mesh) :
+    points(mesh.points),
+    colours(mesh.colours),
+    m(mesh.m),
+    bounds(mesh.bounds),
+    bounding_sphere(mesh.bounding_sphere) {}
+
+Mesh::Mesh(Mesh &&mesh) noexcept :
+    points(std::move(mesh.points)),
+    colours(std::move(mesh.colours)),
+    m(mesh.m),
+    vertex_range(mesh.vertex_range),
+    bounds(mesh.bounds),
+    bounding_sphere(mesh.bounding_sphere) {
+    mesh.vertex_range = no_range;
+}
+
+Mesh& Mesh::operator=(const Mesh &mesh) {
+    if(this != &mesh) {
+        releaseBuffers();
+        points = mesh.points;
+        colours = mesh.colours;
+        m = mesh.m;
+        bounds = mesh.bounds;
+        bounding_sphere = mesh.bounding_sphere;
+    }
+    return *this;
+}
+
+Mesh& Mesh::operator=(Mesh &&mesh) noexcept {
+    if(this != &mesh) {
+        releaseBuffers();
+        points = std::move(mesh.points);
+        colours = std::move(mesh.colours);
+        m = mesh.m;
+        vertex_range = mesh.vertex_range;
+        mesh.vertex_range = no_range;
+        bounds = mesh.bounds;
+        bounding_sphere = mesh.bounding_sphere;
+    }
+    return *this;
 }
 
 void Mesh::prepareBuffers() {
-    vector<GLfloat> points = pointsUnwound();
-    vector<GLfloat> colours = coloursUnwound();
-    
-    /**
-     *  Buffer for the points
-     */
-    GLuint points_vbo;
-    glGenBuffers(1, &points_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
-    glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(GLfloat), &points[0], GL_STATIC_DRAW);
-    
-    /**
-     *  Buffer for the colours
-     */
-    GLuint colours_vbo;
-    glGenBuffers(1, &colours_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, colours_vbo);
-    glBufferData(GL_ARRAY_BUFFER, colours.size() * sizeof(GLfloat), &colours[0], GL_STATIC_DRAW);
-    
-    /**
-     *  Teeing up the VAO (vertex array object)
-     */
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glBindBuffer(GL_ARRAY_BUFFER, colours_vbo);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
+    releaseBuffers();
+    vertex_range = MeshBuffers::allocate(pointsUnwound(), coloursUnwound());
+}
+
+void Mesh::releaseBuffers() {
+    if(no_range != vertex_range) {
+        MeshBuffers::free(vertex_range);
+        vertex_range = no_range;
+    }
 }
 
 GLuint Mesh::getVao() const {
-    return vao;
+    return MeshBuffers::getVao();
+}
+
+/**
+ *  This can change if the arena gets defragmented,
+ *  so look it up each time the mesh is drawn.
+ */
+GLint Mesh::firstVertex() const {
+    return MeshBuffers::first(vertex_range);
 }
 
 int Mesh::pointsSize() const {
@@ -71,6 +104,38 @@ Matrices* Mesh::getMatrices() const {
     return &m;
 }
 
+void Mesh::computeBounds() {
+    bounds = aabb_from_points(points);
+    bounding_sphere = sphere_from_points(points, bounds);
+}
+
+AABB Mesh::getBounds() const {
+    return bounds;
+}
+
+BoundingSphere Mesh::getBoundingSphere() const {
+    return bounding_sphere;
+}
+
+/**
+ *  The same matrix that applyIdentityMatrix sends to the
+ *  shader, as a mat4 we can use on the CPU side.
+ */
+mat4 Mesh::worldMatrix() const {
+    vector<GLfloat> unwound = m.identity_matrix().unwind();
+    mat4 world;
+    copy(begin(unwound), end(unwound), world.m);
+    return world;
+}
+
+AABB Mesh::worldBounds() const {
+    return transform_aabb(bounds, worldMatrix());
+}
+
+BoundingSphere Mesh::worldBoundingSphere() const {
+    return transform_sphere(bounding_sphere, worldMatrix());
+}
+
 vector<GLfloat> Mesh::pointsUnwound() const {
     vector<GLfloat> points_unwound;
     points_unwound.reserve(points.size() * 3);
@@ -209,6 +274,7 @@ void Mesh::generateCube(float size) {
         {0.25f, 0.5f, 1.0f},
     };
     
+    computeBounds();
 }
 
 /**
@@ -228,6 +294,21 @@ void Mesh::applyIdentityMatrix(GLuint program) const {
     }
 }
 
+/**
+ *  Sends a world matrix worked out somewhere else (like a
+ *  SceneGraph) to the same uniform as applyIdentityMatrix.
+ */
+void Mesh::applyWorldMatrix(GLuint program, const mat4 &world) const {
+    GLint identity_matrix_loc = glGetUniformLocation(program, "identity_matrix");
+    
+    if(-1 != identity_matrix_loc) {
+        glUniformMatrix4fv(identity_matrix_loc, 1, GL_FALSE, world.m);
+    }
+    else {
+        cout << "The world matrix could not be applied to this mesh." << endl;
+    }
+}
+
 /**
  *  And this will apply the translation matrix only. We will try out 
  *  Quaternion based rotation functions.
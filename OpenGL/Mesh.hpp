@@ -9,12 +9,15 @@
 #ifndef Mesh_hpp
 #define Mesh_hpp
 
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <iostream>
 #include "Matrices.hpp"
 #include "Structs.h"
+#include "VecMat.hpp"
+#include "Bounds.hpp"
+#include "RangeAllocator.hpp"
 
 class Mesh {
     
@@ -22,24 +25,63 @@ private:
     std::vector<Point> points;
     std::vector<Colour> colours;
     mutable Matrices m;
-    GLuint vao;
+    
+    /**
+     *  Where the vertices live in the shared
+     *  MeshBuffers arena, once prepared.
+     */
+    RangeHandle vertex_range = no_range;
+    
+    /**
+     *  Bounds in model space, worked out
+     *  whenever the points change.
+     */
+    AABB bounds;
+    BoundingSphere bounding_sphere;
+    void computeBounds();
     
 public:
     Mesh();
     Mesh(std::vector<Point> _points, std::vector<Colour> _colours);
     ~Mesh();
     
+    /**
+     *  A copy gets the points and colours but not the range
+     *  in the arena, so it has to be prepared before it is
+     *  drawn, and releasing it never touches the original's
+     *  range. Moving hands the range over.
+     */
+    Mesh(const Mesh &mesh);
+    Mesh(Mesh &&mesh) noexcept;
+    Mesh& operator=(const Mesh &mesh);
+    Mesh& operator=(Mesh &&mesh) noexcept;
+    
+    /**
+     *  Copies the vertices in to the shared arena. The range
+     *  is not given back when the mesh is destroyed, as that
+     *  can happen after the GL context has gone, so release
+     *  it while the context is still around.
+     */
     void prepareBuffers();
+    void releaseBuffers();
     GLuint getVao() const;
+    GLint firstVertex() const;
     int pointsSize() const;
     int coloursSize() const;
     Matrices* getMatrices() const;
     
+    AABB getBounds() const;
+    BoundingSphere getBoundingSphere() const;
+    mat4 worldMatrix() const;
+    AABB worldBounds() const;
+    BoundingSphere worldBoundingSphere() const;
+    
     std::vector<GLfloat> pointsUnwound() const;
     std::vector<GLfloat> coloursUnwound() const;
     
     void generateCube(float size);
     void applyIdentityMatrix(GLuint program) const;
+    void applyWorldMatrix(GLuint program, const mat4 &world) const;
     void applyTranslationMatrix(GLuint program) const;
     void applyMatrices(GLuint program) const;
 };
@@ -0,0 +1,79 @@
+//
+//  MeshBuffers.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 28/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "MeshBuffers.hpp"
+#include <cstddef>
+#include "GLState.hpp"
+
+using namespace std;
+
+/**
+ *  Enough for a few hundred cubes before it has to grow.
+ */
+#define mesh_buffers_capacity 16384
+
+/**
+ *  Position, colour and slot, one after the other.
+ */
+struct MeshVertex {
+    GLfloat position[3];
+    GLfloat colour[3];
+    GLuint slot;
+};
+
+MeshBuffers::MeshBuffers() : vertices(GL_ARRAY_BUFFER, sizeof(MeshVertex), mesh_buffers_capacity) {}
+
+MeshBuffers& MeshBuffers::getInstance() {
+    static MeshBuffers instance;
+    return instance;
+}
+
+RangeHandle MeshBuffers::_allocate(const vector<GLfloat> &points, const vector<GLfloat> &colours, GLuint slot) {
+    const size_t count = points.size() / 3;
+    
+    vector<MeshVertex> interleaved(count);
+    for(size_t i = 0; i < count; i++) {
+        MeshVertex &vertex = interleaved[i];
+        for(int j = 0; j < 3; j++) {
+            size_t c = i * 3 + j;
+            vertex.position[j] = points[c];
+            vertex.colour[j] = c < colours.size() ? colours[c] : 1.0f;
+        }
+        vertex.slot = slot;
+    }
+    
+    RangeHandle handle = vertices.allocate(interleaved.empty() ? NULL : &interleaved[0], count);
+    
+    /**
+     *  The buffer keeps its name for good once it has
+     *  been made, so the VAO only needs setting up once.
+     */
+    if(!vao) {
+        const GLsizei stride = sizeof(MeshVertex);
+        glGenVertexArrays(1, &vao);
+        GLState::bindVertexArray(vao);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, vertices.getBuffer());
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)offsetof(MeshVertex, position));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)offsetof(MeshVertex, colour));
+        glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, stride, (const GLvoid *)offsetof(MeshVertex, slot));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+    }
+    
+    return handle;
+}
+
+void MeshBuffers::_release(void) {
+    if(vao) {
+        GLState::forgetVertexArray(vao);
+        glDeleteVertexArrays(1, &vao);
+        vao = 0;
+    }
+    vertices.release();
+}
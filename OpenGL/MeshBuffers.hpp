@@ -0,0 +1,79 @@
+//
+//  MeshBuffers.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 28/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef MeshBuffers_hpp
+#define MeshBuffers_hpp
+
+#include "GLPlatform.h"
+#include <vector>
+#include "BufferArena.hpp"
+
+/**
+ *  The vertex arena every Mesh puts its points and colours in
+ *  to, interleaved, behind one VAO. Drawing a mesh is then just
+ *  a matter of the first vertex and the count, and switching
+ *  between meshes never needs a new VAO.
+ *
+ *  Each vertex also carries a slot (attribute 2, an integer),
+ *  which StaticBatch uses to find each vertex's world matrix.
+ *  Plain meshes leave it at 0 and their shaders ignore it.
+ */
+class MeshBuffers {
+
+private:
+    MeshBuffers();
+    ~MeshBuffers() {};
+    MeshBuffers(MeshBuffers const &);
+    void operator=(MeshBuffers const &);
+    static MeshBuffers& getInstance();
+    
+    BufferArena vertices;
+    GLuint vao = 0;
+    
+    RangeHandle _allocate(const std::vector<GLfloat> &points, const std::vector<GLfloat> &colours, GLuint slot);
+    void _release(void);
+
+public:
+    static RangeHandle allocate(const std::vector<GLfloat> &points, const std::vector<GLfloat> &colours, GLuint slot = 0) {
+        return getInstance()._allocate(points, colours, slot);
+    }
+    
+    static void free(RangeHandle handle) {
+        getInstance().vertices.free(handle);
+    }
+    
+    static GLint first(RangeHandle handle) {
+        return getInstance().vertices.first(handle);
+    }
+    
+    static GLsizei count(RangeHandle handle) {
+        return getInstance().vertices.count(handle);
+    }
+    
+    static GLuint getVao(void) {
+        return getInstance().vao;
+    }
+    
+    static void defragment(void) {
+        getInstance().vertices.defragment();
+    }
+    
+    static RangeStats stats(void) {
+        return getInstance().vertices.stats();
+    }
+    
+    /**
+     *  Deletes the buffer and VAO, for when the
+     *  context they were made in is going away.
+     */
+    static void release(void) {
+        getInstance()._release();
+    }
+};
+
+#endif /* MeshBuffers_hpp */
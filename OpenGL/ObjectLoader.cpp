@@ -7,15 +7,16 @@
 //
 
 #include "ObjectLoader.hpp"
+#include "Logger.hpp"
 
 using namespace std;
 
 ObjectLoader::ObjectLoader(void) {
-    cout << "Construct: ObjectLoader" << endl;
+    LOG_DEBUG("Construct: ObjectLoader");
 }
 
 ObjectLoader::~ObjectLoader(void) {
-    cout << "Destruct: ObjectLoader" << endl;
+    LOG_DEBUG("Destruct: ObjectLoader");
     vertices.clear();
     normals.clear();
     texture_coords.clear();
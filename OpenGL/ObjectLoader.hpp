@@ -15,7 +15,7 @@
 #include <vector>
 #include <algorithm>
 #include <string>
-#include <GLFW/glfw3.h>
+#include "GLPlatform.h"
 #include "Enumerations.h"
 
 class ObjectLoader {
@@ -0,0 +1,240 @@
+//
+//  PerspectiveCamera.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 04/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "PerspectiveCamera.hpp"
+#include <sstream>
+
+using namespace std;
+
+/**
+ *  The camera moves in steps of this many seconds.
+ */
+#define camera_step (1.0 / 120.0)
+
+/**
+ *  Longer frames (like the first, or after a stall) are cut
+ *  down to this, so we never try to catch up all at once.
+ */
+#define camera_max_frame_time 0.25
+
+#define camera_min_fov 20.0f
+#define camera_max_fov 100.0f
+
+/**
+ *  Standard depth can't reach infinity, so an
+ *  infinite far plane falls back to this.
+ */
+#define camera_standard_far 100.0f
+
+CameraInput::CameraInput() : move(0.0f, 0.0f, 0.0f), pitch(0.0f), yaw(0.0f), roll(0.0f) {}
+
+static float clamp_unit(float value) {
+    return value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+}
+
+PerspectiveCamera::PerspectiveCamera() {
+    cam_pos = vec3(0.0f, 0.0f, 0.0f);
+    orientation = quat_from_axis_deg(0.0f, 0.0f, 1.0f, 0.0f);
+    previous_pos = view_pos = cam_pos;
+    previous_orientation = orientation;
+    updateAxes();
+    updateProjection();
+    rebuildView(1.0f);
+}
+
+/**
+ *  The axes come straight out of the
+ *  columns of the rotation matrix.
+ */
+void PerspectiveCamera::updateAxes(void) {
+    mat4 R = quat_to_mat4(orientation);
+    rgt = vec3(R.m[0], R.m[1], R.m[2]);
+    up = vec3(R.m[4], R.m[5], R.m[6]);
+    fwd = vec3(-R.m[8], -R.m[9], -R.m[10]);
+}
+
+void PerspectiveCamera::updateProjection(void) {
+    aspect = (float)viewport_w / (float)viewport_h;
+    
+    if(CLIP_DEPTH_REVERSED == clip_depth) {
+        proj_mat = perspective_reverse_z(fov, aspect, near, far);
+    }
+    else {
+        proj_mat = perspective(fov, aspect, near, far > near ? far : camera_standard_far);
+    }
+}
+
+void PerspectiveCamera::setViewportSize(int w, int h) {
+    viewport_w = w > 0 ? w : 1;
+    viewport_h = h > 0 ? h : 1;
+    updateProjection();
+}
+
+void PerspectiveCamera::setPosition(const vec3 &position) {
+    cam_pos = previous_pos = position;
+    accumulator = 0.0;
+    rebuildView(1.0f);
+}
+
+void PerspectiveCamera::setOrientation(const versor &rotation) {
+    orientation = rotation;
+    normalise(orientation);
+    previous_orientation = orientation;
+    accumulator = 0.0;
+    updateAxes();
+    rebuildView(1.0f);
+}
+
+bool PerspectiveCamera::setFov(float degrees) {
+    if(degrees <= camera_min_fov || degrees >= camera_max_fov) {
+        return false;
+    }
+    fov = degrees;
+    updateProjection();
+    return true;
+}
+
+void PerspectiveCamera::setClipDepth(ClipDepth depth) {
+    clip_depth = depth;
+    updateProjection();
+}
+
+void PerspectiveCamera::setFarPlane(float distance) {
+    far = distance;
+    updateProjection();
+}
+
+/**
+ *  Each part is kept to -1 to 1, so holding a key and
+ *  pushing a stick the same way doesn't go faster.
+ */
+void PerspectiveCamera::input(const CameraInput &input) {
+    for(int i = 0; i < 3; i++) {
+        frame_input.move.v[i] = clamp_unit(frame_input.move.v[i] + input.move.v[i]);
+    }
+    frame_input.pitch = clamp_unit(frame_input.pitch + input.pitch);
+    frame_input.yaw = clamp_unit(frame_input.yaw + input.yaw);
+    frame_input.roll = clamp_unit(frame_input.roll + input.roll);
+}
+
+/**
+ *  Pitch, yaw and roll turn about the camera's own right, up
+ *  and forward axes, so they are put together in to one turn
+ *  in camera space and applied with a single multiply on the
+ *  right.
+ */
+void PerspectiveCamera::step(float dt) {
+    const float heading = cam_heading_speed * dt;
+    
+    if(frame_input.pitch != 0.0f || frame_input.yaw != 0.0f || frame_input.roll != 0.0f) {
+        versor q_pitch = quat_from_axis_deg(heading * frame_input.pitch, 1.0f, 0.0f, 0.0f);
+        versor q_yaw = quat_from_axis_deg(heading * frame_input.yaw, 0.0f, 1.0f, 0.0f);
+        versor q_roll = quat_from_axis_deg(heading * frame_input.roll, 0.0f, 0.0f, -1.0f);
+        versor q_turn = q_pitch * (q_yaw * q_roll);
+        
+        orientation = orientation * q_turn;
+        normalise(orientation);
+        updateAxes();
+    }
+    
+    const float distance = cam_speed * dt;
+    const vec3 &move = frame_input.move;
+    for(int i = 0; i < 3; i++) {
+        cam_pos.v[i] += (rgt.v[i] * move.v[0] + up.v[i] * move.v[1] - fwd.v[i] * move.v[2]) * distance;
+    }
+}
+
+/**
+ *  The camera only rotates and moves, so its inverse
+ *  can be had by transposing rather than a full inverse.
+ */
+void PerspectiveCamera::rebuildView(float alpha) {
+    for(int i = 0; i < 3; i++) {
+        view_pos.v[i] = previous_pos.v[i] + (cam_pos.v[i] - previous_pos.v[i]) * alpha;
+    }
+    
+    versor from = previous_orientation;
+    versor to = orientation;
+    versor q = slerp(from, to, alpha);
+    normalise(q);
+    
+    mat4 camera_world = quat_to_mat4(q);
+    camera_world.m[12] = view_pos.v[0];
+    camera_world.m[13] = view_pos.v[1];
+    camera_world.m[14] = view_pos.v[2];
+    
+    view_mat = rigid_inverse(camera_world);
+}
+
+void PerspectiveCamera::advance(double dt) {
+    if(dt > camera_max_frame_time) {
+        dt = camera_max_frame_time;
+    }
+    
+    accumulator += dt;
+    while(accumulator >= camera_step) {
+        previous_pos = cam_pos;
+        previous_orientation = orientation;
+        
+        step((float)camera_step);
+        accumulator -= camera_step;
+    }
+    
+    frame_input = CameraInput();
+    rebuildView((float)(accumulator / camera_step));
+}
+
+const mat4& PerspectiveCamera::view(void) const {
+    return view_mat;
+}
+
+const mat4& PerspectiveCamera::projection(void) const {
+    return proj_mat;
+}
+
+mat4 PerspectiveCamera::viewProjection(void) const {
+    mat4 proj = proj_mat;
+    return proj * view_mat;
+}
+
+Frustum PerspectiveCamera::frustum(void) const {
+    return Frustum(viewProjection(), clip_depth);
+}
+
+Ray PerspectiveCamera::screenRay(float x, float y) const {
+    return ray_from_screen(x, y, viewport_w, viewport_h, inverse(viewProjection()), clip_depth);
+}
+
+vec3 PerspectiveCamera::position(void) const {
+    return view_pos;
+}
+
+float PerspectiveCamera::fieldOfView(void) const {
+    return fov;
+}
+
+float PerspectiveCamera::nearPlane(void) const {
+    return near;
+}
+
+/**
+ *  infinite_far if there is no far plane.
+ */
+float PerspectiveCamera::farPlane(void) const {
+    return CLIP_DEPTH_REVERSED == clip_depth || far > near ? far : camera_standard_far;
+}
+
+ClipDepth PerspectiveCamera::clipDepth(void) const {
+    return clip_depth;
+}
+
+string PerspectiveCamera::repr(void) const {
+    stringstream oss;
+    oss << "Camera fov: \t" << fov << endl;
+    return oss.str();
+}
@@ -0,0 +1,154 @@
+//
+//  PerspectiveCamera.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 04/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef PerspectiveCamera_hpp
+#define PerspectiveCamera_hpp
+
+#include <string>
+#include "VecMat.hpp"
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+
+/**
+ *  What the camera has been asked to do this frame. Each part
+ *  runs from -1 to 1 and is scaled by the camera's speeds.
+ *
+ *  -   move is along the camera's right, up and back axes.
+ *  -   pitch, yaw and roll turn it about right, up and forward.
+ */
+struct CameraInput {
+    CameraInput();
+    vec3 move;
+    float pitch;
+    float yaw;
+    float roll;
+};
+
+/**
+ *  A camera as a plain value: where it is, which way it faces
+ *  and how it projects, with the view and projection matrices
+ *  worked out from that. It never touches GL, so there can be
+ *  as many as we like (split screen, shadow maps, overviews)
+ *  and it is up to whoever draws to send the matrices on.
+ *
+ *  Movement runs in fixed steps, so it is the same whatever
+ *  the frame rate, and the matrices are for somewhere between
+ *  the last two steps so it still looks smooth.
+ */
+class PerspectiveCamera {
+
+private:
+    vec3 cam_pos;
+    versor orientation;
+    
+    /**
+     *  Where the camera was at the step before, and where
+     *  it was drawn, between that and cam_pos.
+     */
+    vec3 previous_pos;
+    versor previous_orientation;
+    vec3 view_pos;
+    
+    /**
+     *  The camera's own axes, in world space.
+     */
+    vec3 fwd;
+    vec3 rgt;
+    vec3 up;
+    
+    mat4 view_mat;
+    mat4 proj_mat;
+    
+    int viewport_w = 1;
+    int viewport_h = 1;
+    float fov = 67.0f;
+    float near = 0.1f;
+    float far = 100.0f;
+    float aspect = 1.0f;
+    ClipDepth clip_depth = CLIP_DEPTH_STANDARD;
+    
+    /**
+     *  Units and degrees per second.
+     */
+    float cam_speed = 15.0f;
+    float cam_heading_speed = 60.0f;
+    
+    /**
+     *  Input gathered this frame, and time
+     *  not yet used up by a step.
+     */
+    CameraInput frame_input;
+    double accumulator = 0.0;
+    
+    void updateAxes(void);
+    void updateProjection(void);
+    void step(float dt);
+    void rebuildView(float alpha);
+
+public:
+    PerspectiveCamera();
+    
+    /**
+     *  Sizes the projection to the viewport
+     *  it will be drawn in to.
+     */
+    void setViewportSize(int w, int h);
+    
+    /**
+     *  Jumps straight to a place, with nothing
+     *  in between to interpolate.
+     */
+    void setPosition(const vec3 &position);
+    void setOrientation(const versor &rotation);
+    
+    /**
+     *  Returns false, leaving the fov alone, if
+     *  it would go outside 20 to 100 degrees.
+     */
+    bool setFov(float degrees);
+    
+    /**
+     *  Reversed depth needs the renderer to match (see
+     *  DepthTarget). Only reversed depth can have a far
+     *  plane of infinite_far.
+     */
+    void setClipDepth(ClipDepth depth);
+    void setFarPlane(float distance);
+    
+    /**
+     *  Adds to this frame's input. Call as many
+     *  times as you like before advance.
+     */
+    void input(const CameraInput &input);
+    
+    /**
+     *  Moves on by dt seconds and rebuilds the view matrix.
+     */
+    void advance(double dt);
+    
+    const mat4& view(void) const;
+    const mat4& projection(void) const;
+    mat4 viewProjection(void) const;
+    
+    Frustum frustum(void) const;
+    
+    /**
+     *  A ray from the camera through a point in its viewport.
+     */
+    Ray screenRay(float x, float y) const;
+    
+    vec3 position(void) const;
+    float fieldOfView(void) const;
+    float nearPlane(void) const;
+    float farPlane(void) const;
+    ClipDepth clipDepth(void) const;
+    
+    std::string repr(void) const;
+};
+
+#endif /* PerspectiveCamera_hpp */
@@ -10,7 +10,7 @@
 #define Points_h
 
 #include <vector>
-#include <GLFW/glfw3.h>
+#include "GLPlatform.h"
 
 /**
  *  Teeing up the points and colours 
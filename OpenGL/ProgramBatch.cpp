@@ -0,0 +1,200 @@
+//
+//  ProgramBatch.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 02/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "ProgramBatch.hpp"
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <iostream>
+#include "GLParams.hpp"
+#include "GLUtilities.hpp"
+#include "ProgramCache.hpp"
+
+using namespace std;
+
+/**
+ *  The KHR and ARB extensions share these values,
+ *  and older headers (MacOS) have neither.
+ */
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#define max_compiler_threads 0xFFFFFFFF
+
+typedef void (*MaxShaderCompilerThreads)(GLuint count);
+
+static bool has_extension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0; i < count; i++) {
+        const GLubyte *extension = glGetStringi(GL_EXTENSIONS, i);
+        if(extension && 0 == strcmp((const char *)extension, name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ProgramBatch::ProgramBatch() {}
+
+ProgramBatch::~ProgramBatch() {
+    
+    /**
+     *  Anything never asked for is thrown away.
+     */
+    for(auto &entry: entries) {
+        if(entry.resolved) {
+            continue;
+        }
+        if(entry.vertex_shader) {
+            glDeleteShader(entry.vertex_shader);
+        }
+        if(entry.fragment_shader) {
+            glDeleteShader(entry.fragment_shader);
+        }
+        if(entry.program) {
+            glDeleteProgram(entry.program);
+        }
+    }
+}
+
+size_t ProgramBatch::size(void) const {
+    return entries.size();
+}
+
+bool ProgramBatch::isParallel(void) const {
+    return parallel;
+}
+
+int ProgramBatch::add(const string &vertex_src, const string &fragment_src) {
+    entries.push_back({vertex_src, fragment_src, 0, 0, 0, false});
+    return (int)entries.size() - 1;
+}
+
+void ProgramBatch::submit(void) {
+    if(!submitted) {
+        submitted = true;
+        
+        const char *names[2] = {"glMaxShaderCompilerThreadsKHR", "glMaxShaderCompilerThreadsARB"};
+        if(has_extension("GL_KHR_parallel_shader_compile") || has_extension("GL_ARB_parallel_shader_compile")) {
+            parallel = true;
+            
+            /**
+             *  Let the driver use as many threads as it likes.
+             */
+            for(const char *name: names) {
+                MaxShaderCompilerThreads max_threads = (MaxShaderCompilerThreads)glfwGetProcAddress(name);
+                if(max_threads) {
+                    max_threads(max_compiler_threads);
+                    break;
+                }
+            }
+        }
+    }
+    
+    /**
+     *  Every compile goes out before any link,
+     *  so none of them wait on each other.
+     */
+    for(auto &entry: entries) {
+        if(entry.resolved || entry.program) {
+            continue;
+        }
+        
+        entry.program = ProgramCache::find(entry.vertex_src, entry.fragment_src);
+        if(entry.program) {
+            entry.resolved = true;
+            continue;
+        }
+        
+        const string *sources[2] = {&entry.vertex_src, &entry.fragment_src};
+        GLuint *shaders[2] = {&entry.vertex_shader, &entry.fragment_shader};
+        const GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+        
+        for(int i = 0; i < 2; i++) {
+            const char *src = sources[i]->c_str();
+            GLint length = (GLint)sources[i]->length();
+            *shaders[i] = glCreateShader(types[i]);
+            glShaderSource(*shaders[i], 1, &src, &length);
+            glCompileShader(*shaders[i]);
+        }
+    }
+    
+    for(auto &entry: entries) {
+        if(entry.resolved || entry.program) {
+            continue;
+        }
+        
+        entry.program = glCreateProgram();
+        ProgramCache::prepare(entry.program);
+        glAttachShader(entry.program, entry.vertex_shader);
+        glAttachShader(entry.program, entry.fragment_shader);
+        glLinkProgram(entry.program);
+    }
+}
+
+bool ProgramBatch::ready(int index) const {
+    const ProgramEntry &entry = entries[index];
+    if(entry.resolved || !parallel || !entry.program) {
+        return true;
+    }
+    
+    GLint done = GL_FALSE;
+    glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &done);
+    return GL_TRUE == done;
+}
+
+bool ProgramBatch::allReady(void) const {
+    for(int i = 0; i < (int)entries.size(); i++) {
+        if(!ready(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProgramBatch::resolve(ProgramEntry &entry) {
+    GLuint shaders[2] = {entry.vertex_shader, entry.fragment_shader};
+    
+    if(GL_TRUE == GLUtilities::programReady(entry.program)) {
+        ProgramCache::store(entry.vertex_src, entry.fragment_src, entry.program);
+    }
+    else {
+        for(GLuint shader: shaders) {
+            GLint status = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+            if(GL_TRUE != status) {
+                cout << "Failed to compile the shader with reference: " << shader << endl;
+                GLParams::print_shader_log(shader);
+            }
+        }
+        cout << "Failed to link the program with reference: " << entry.program << endl;
+        GLParams::print_program_info_log(entry.program);
+    }
+    
+    for(GLuint shader: shaders) {
+        glDetachShader(entry.program, shader);
+        glDeleteShader(shader);
+    }
+    
+    entry.vertex_shader = entry.fragment_shader = 0;
+    entry.resolved = true;
+}
+
+GLuint ProgramBatch::program(int index) {
+    ProgramEntry &entry = entries[index];
+    
+    if(!entry.program) {
+        submit();
+    }
+    if(!entry.resolved) {
+        resolve(entry);
+    }
+    
+    return entry.program;
+}
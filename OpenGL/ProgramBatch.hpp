@@ -0,0 +1,82 @@
+//
+//  ProgramBatch.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 02/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef ProgramBatch_hpp
+#define ProgramBatch_hpp
+
+#include "GLPlatform.h"
+#include <string>
+#include <vector>
+
+/**
+ *  Builds a set of programs together. submit starts every
+ *  compile and link without asking how any of them went, as
+ *  asking makes the driver finish that one before carrying on.
+ *  Status is only checked when a program is asked for, so a
+ *  driver that compiles on its own threads can get on with all
+ *  of them while we do something else, like load meshes.
+ *
+ *  With KHR_parallel_shader_compile (or the ARB version) ready
+ *  can say whether a program is done without waiting for it.
+ *  Programs the ProgramCache already has skip all of this.
+ */
+class ProgramBatch {
+
+private:
+    struct ProgramEntry {
+        std::string vertex_src;
+        std::string fragment_src;
+        GLuint vertex_shader;
+        GLuint fragment_shader;
+        GLuint program;
+        bool resolved;
+    };
+    
+    std::vector<ProgramEntry> entries;
+    bool parallel = false;
+    bool submitted = false;
+    
+    ProgramBatch(const ProgramBatch &);
+    void operator=(const ProgramBatch &);
+    
+    void resolve(ProgramEntry &entry);
+
+public:
+    ProgramBatch();
+    ~ProgramBatch();
+    
+    /**
+     *  Adds a program to build. Returns its index.
+     */
+    int add(const std::string &vertex_src, const std::string &fragment_src);
+    
+    /**
+     *  Starts building everything added so far.
+     *  Needs a current context.
+     */
+    void submit(void);
+    
+    /**
+     *  True if program(index) won't have to wait. Without the
+     *  parallel compile extension there is no way to tell, so
+     *  this is always true and program may wait.
+     */
+    bool ready(int index) const;
+    bool allReady(void) const;
+    
+    /**
+     *  The linked program, waiting for it if need be. Failures
+     *  print their logs, as compileShader and linkShaders do.
+     */
+    GLuint program(int index);
+    
+    size_t size(void) const;
+    bool isParallel(void) const;
+};
+
+#endif /* ProgramBatch_hpp */
@@ -0,0 +1,279 @@
+//
+//  ProgramCache.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 31/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "ProgramCache.hpp"
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include "GLParams.hpp"
+#include "GLUtilities.hpp"
+#include "GLState.hpp"
+
+using namespace std;
+
+/**
+ *  Next to the executable, like the shaders.
+ */
+#define program_cache_dir "program_cache"
+#define program_cache_ext ".bin"
+
+/**
+ *  Bump this if the file layout changes.
+ */
+#define program_cache_magic 0x42504c47
+#define program_cache_version 1
+
+/**
+ *  What goes before the binary in each file.
+ */
+struct ProgramCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+ProgramCache::ProgramCache() {}
+
+ProgramCache& ProgramCache::getInstance() {
+    static ProgramCache instance;
+    return instance;
+}
+
+/**
+ *  FNV-1a over each string in turn, with a zero
+ *  between them so "ab" + "c" != "a" + "bc".
+ */
+uint64_t ProgramCache::key(const string &vertex_src, const string &fragment_src) const {
+    const GLubyte *vendor = glGetString(GL_VENDOR);
+    const GLubyte *renderer = glGetString(GL_RENDERER);
+    const GLubyte *version = glGetString(GL_VERSION);
+    
+    const string parts[5] = {
+        vertex_src,
+        fragment_src,
+        vendor ? (const char *)vendor : "",
+        renderer ? (const char *)renderer : "",
+        version ? (const char *)version : ""
+    };
+    
+    uint64_t hash = 14695981039346656037ULL;
+    for(const auto &part: parts) {
+        for(unsigned char c: part) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        hash = hash * 1099511628211ULL;
+    }
+    return hash;
+}
+
+string ProgramCache::path(uint64_t key) const {
+    stringstream ss;
+    ss << program_cache_dir << "/" << hex << setw(16) << setfill('0') << key << program_cache_ext;
+    return ss.str();
+}
+
+bool ProgramCache::read(uint64_t key, GLenum &format, vector<char> &binary) const {
+    ifstream file(path(key), ios::in | ios::binary);
+    if(!file.is_open()) {
+        return false;
+    }
+    
+    ProgramCacheHeader header;
+    if(!file.read((char *)&header, sizeof(header))) {
+        return false;
+    }
+    
+    if(program_cache_magic != header.magic || program_cache_version != header.version || key != header.key || 0 == header.length) {
+        return false;
+    }
+    
+    binary.resize(header.length);
+    if(!file.read(&binary[0], header.length)) {
+        return false;
+    }
+    
+    format = header.format;
+    return true;
+}
+
+void ProgramCache::write(uint64_t key, GLuint program) const {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0) {
+        return;
+    }
+    
+    vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, &binary[0]);
+    if(length <= 0) {
+        return;
+    }
+    
+    mkdir(program_cache_dir, 0755);
+    
+    ofstream file(path(key), ios::out | ios::binary | ios::trunc);
+    if(!file.is_open()) {
+        cerr << "Could not write the program cache: " << path(key) << endl;
+        return;
+    }
+    
+    ProgramCacheHeader header = {program_cache_magic, program_cache_version, key, format, (uint32_t)length};
+    file.write((const char *)&header, sizeof(header));
+    file.write(&binary[0], length);
+}
+
+/**
+ *  Some drivers (MacOS among them) can't
+ *  give binaries back at all.
+ */
+bool ProgramCache::binaries(void) const {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+GLuint ProgramCache::_find(const string &vertex_src, const string &fragment_src) {
+    const uint64_t program_key = key(vertex_src, fragment_src);
+    
+    auto found = linked.find(program_key);
+    if(found != linked.end()) {
+        shared++;
+        return found->second;
+    }
+    
+    GLenum format;
+    vector<char> binary;
+    if(binaries() && read(program_key, format, binary)) {
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, format, &binary[0], (GLsizei)binary.size());
+        
+        if(GL_TRUE == GLUtilities::programReady(program)) {
+            hits++;
+            linked[program_key] = program;
+            return program;
+        }
+        
+        /**
+         *  A driver update can turn down a binary
+         *  even when the strings we hashed match.
+         */
+        glDeleteProgram(program);
+    }
+    
+    misses++;
+    return 0;
+}
+
+void ProgramCache::_prepare(GLuint program) {
+    if(binaries()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void ProgramCache::_store(const string &vertex_src, const string &fragment_src, GLuint program) {
+    const uint64_t program_key = key(vertex_src, fragment_src);
+    
+    if(binaries()) {
+        write(program_key, program);
+    }
+    
+    linked[program_key] = program;
+}
+
+GLuint ProgramCache::_program(const string &vertex_src, const string &fragment_src) {
+    GLuint program = _find(vertex_src, fragment_src);
+    if(program) {
+        return program;
+    }
+    
+    GLuint vertex_shader = GLUtilities::compileShader(vertex_src, GL_VERTEX_SHADER);
+    GLuint fragment_shader = GLUtilities::compileShader(fragment_src, GL_FRAGMENT_SHADER);
+    
+    program = glCreateProgram();
+    _prepare(program);
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+    
+    /**
+     *  The program keeps what it needs once
+     *  linked, so the shaders can go.
+     */
+    glDetachShader(program, vertex_shader);
+    glDetachShader(program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    
+    if(GL_TRUE != GLUtilities::programReady(program)) {
+        cout << "Failed to link the program with reference: " << program << endl;
+        GLParams::print_program_info_log(program);
+        return program;
+    }
+    
+    _store(vertex_src, fragment_src, program);
+    return program;
+}
+
+/**
+ *  Programs the cache never took are left alone,
+ *  as they still belong to whoever made them.
+ */
+void ProgramCache::_evict(GLuint program) {
+    bool owned = false;
+    for(auto entry = linked.begin(); entry != linked.end();) {
+        if(entry->second == program) {
+            entry = linked.erase(entry);
+            owned = true;
+        }
+        else {
+            ++entry;
+        }
+    }
+    
+    if(owned) {
+        GLState::forgetProgram(program);
+        glDeleteProgram(program);
+    }
+}
+
+void ProgramCache::_release(void) {
+    for(auto &entry: linked) {
+        GLState::forgetProgram(entry.second);
+        glDeleteProgram(entry.second);
+    }
+    linked.clear();
+}
+
+void ProgramCache::_clear(void) {
+    DIR *dir = opendir(program_cache_dir);
+    if(!dir) {
+        return;
+    }
+    
+    const string ext = program_cache_ext;
+    while(struct dirent *entry = readdir(dir)) {
+        string name = entry->d_name;
+        if(name.size() > ext.size() && 0 == name.compare(name.size() - ext.size(), ext.size(), ext)) {
+            remove((string(program_cache_dir) + "/" + name).c_str());
+        }
+    }
+    closedir(dir);
+}
+
+string ProgramCache::_repr(void) {
+    stringstream ss;
+    ss << "Program cache hits: " << hits << " misses: " << misses << " shared: " << shared;
+    return ss.str();
+}
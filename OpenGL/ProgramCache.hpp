@@ -0,0 +1,126 @@
+//
+//  ProgramCache.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 31/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef ProgramCache_hpp
+#define ProgramCache_hpp
+
+#include "GLPlatform.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ *  Keeps linked programs on disk with glGetProgramBinary, so
+ *  later runs can load them with glProgramBinary instead of
+ *  compiling and linking the GLSL again.
+ *
+ *  Programs are keyed by a hash of their sources (which hold
+ *  any defines) and the vendor, renderer and version strings,
+ *  as a binary is only any good to the driver that made it.
+ *  If there is no binary, or the driver turns it down, the
+ *  program is built from source and the binary saved again.
+ *
+ *  Asking for the same sources twice gives back the program
+ *  already linked, so shader variants that come out the same
+ *  are only built once.
+ */
+class ProgramCache {
+
+private:
+    ProgramCache();
+    ~ProgramCache() {};
+    ProgramCache(ProgramCache const &);
+    void operator=(ProgramCache const &);
+    static ProgramCache& getInstance();
+    
+    int hits = 0;
+    int misses = 0;
+    int shared = 0;
+    
+    std::map<uint64_t, GLuint> linked;
+    
+    uint64_t key(const std::string &vertex_src, const std::string &fragment_src) const;
+    std::string path(uint64_t key) const;
+    bool read(uint64_t key, GLenum &format, std::vector<char> &binary) const;
+    void write(uint64_t key, GLuint program) const;
+    bool binaries(void) const;
+    
+    GLuint _find(const std::string &vertex_src, const std::string &fragment_src);
+    void _prepare(GLuint program);
+    void _store(const std::string &vertex_src, const std::string &fragment_src, GLuint program);
+    GLuint _program(const std::string &vertex_src, const std::string &fragment_src);
+    void _evict(GLuint program);
+    void _release(void);
+    void _clear(void);
+    std::string _repr(void);
+
+public:
+    
+    /**
+     *  A linked program for the two sources, from
+     *  the cache if it can be. Needs a current context.
+     */
+    static GLuint program(const std::string &vertex_src, const std::string &fragment_src) {
+        return getInstance()._program(vertex_src, fragment_src);
+    }
+    
+    /**
+     *  The program for the two sources if it has been linked
+     *  already or has a binary on disk the driver will take,
+     *  otherwise 0.
+     */
+    static GLuint find(const std::string &vertex_src, const std::string &fragment_src) {
+        return getInstance()._find(vertex_src, fragment_src);
+    }
+    
+    /**
+     *  Call on a program built somewhere else before
+     *  linking it, so its binary can be stored.
+     */
+    static void prepare(GLuint program) {
+        getInstance()._prepare(program);
+    }
+    
+    /**
+     *  Keeps a program that linked, so it can be found again.
+     */
+    static void store(const std::string &vertex_src, const std::string &fragment_src, GLuint program) {
+        getInstance()._store(vertex_src, fragment_src, program);
+    }
+    
+    /**
+     *  Deletes one program handed out earlier, once nothing
+     *  draws with it (like after a shader reload replaced it).
+     *  Its binary stays on disk for the next time.
+     */
+    static void evict(GLuint program) {
+        getInstance()._evict(program);
+    }
+    
+    /**
+     *  Deletes the programs handed out so far. Call before
+     *  the context goes, as their names go with it.
+     */
+    static void release(void) {
+        getInstance()._release();
+    }
+    
+    /**
+     *  Deletes every binary in the cache.
+     */
+    static void clear(void) {
+        getInstance()._clear();
+    }
+    
+    static std::string repr(void) {
+        return getInstance()._repr();
+    }
+};
+
+#endif /* ProgramCache_hpp */
@@ -9,16 +9,33 @@
 #include "QuaternionDemo.hpp"
 #include <iostream>
 #include <string>
+#include <algorithm>
 #include "GLUtilities.hpp"
 #include "GLParams.hpp"
 #include "ShaderLoader.hpp"
+#include "ShaderPreprocessor.hpp"
+#include "ProgramCache.hpp"
 #include "Quaternion.hpp"
 #include "Camera.hpp"
+#include "Input.hpp"
+#include "GLState.hpp"
+#include "MeshBuffers.hpp"
 
 #define gl_viewport_w 1280
 #define gl_viewport_h 720
 
+/**
+ *  The overview sits in the top right corner.
+ */
+#define overview_w 320
+#define overview_h 180
+#define overview_margin 16
+
+#define vertex_shader_path "mesh.vert"
+#define fragment_shader_path "vertex_colour.frag"
+
 using namespace std;
+using namespace std::placeholders;
 
 QuaternionDemo::QuaternionDemo() {
 }
@@ -28,127 +45,385 @@ QuaternionDemo& QuaternionDemo::getInstance() {
     return instance;
 }
 
+/**
+ *  Only starts building the program, so the driver
+ *  can compile it while the meshes are prepared.
+ */
 void QuaternionDemo::createProgram(void) {
-    string vertex_shader_str = ShaderLoader::load("quaternion_demo.vert");
-    string fragment_shader_str = ShaderLoader::load("quaternion_demo.frag");
+    string vertex_shader_str = ShaderPreprocessor::load(vertex_shader_path, {"BATCHED_WORLDS"});
+    string fragment_shader_str = ShaderPreprocessor::load(fragment_shader_path);
     
-    GLuint vertex_shader = GLUtilities::compileShader(vertex_shader_str, GL_VERTEX_SHADER);
-    GLuint fragment_shader = GLUtilities::compileShader(fragment_shader_str, GL_FRAGMENT_SHADER);
+    program_index = programs.add(vertex_shader_str, fragment_shader_str);
+    programs.submit();
     
-    program = GLUtilities::linkShaders(vertex_shader, fragment_shader);
-    GLParams::print_program_info_log(program);
+    watchShaders();
+}
+
+void QuaternionDemo::watchShaders(void) {
+    shader_files.unwatchAll();
+    for(const char *path: {vertex_shader_path, fragment_shader_path}) {
+        for(const auto &file: ShaderPreprocessor::dependencies(path)) {
+            shader_files.watch(file);
+        }
+    }
+}
+
+/**
+ *  Runs at the start of a frame. If any of the shader files
+ *  changed the program is built again, and only swapped in if
+ *  it links, so a mistake leaves the old one drawing.
+ */
+void QuaternionDemo::reloadProgram(void) {
+    if(shader_files.poll().empty()) {
+        return;
+    }
+    
+    ShaderPreprocessor::clear();
+    string vertex_shader_str = ShaderPreprocessor::load(vertex_shader_path, {"BATCHED_WORLDS"});
+    string fragment_shader_str = ShaderPreprocessor::load(fragment_shader_path);
+    watchShaders();
+    
+    GLuint reloaded = ProgramCache::program(vertex_shader_str, fragment_shader_str);
+    if(GL_TRUE != GLUtilities::programReady(reloaded)) {
+        cout << "Shader reload failed, keeping the old program." << endl;
+        glDeleteProgram(reloaded);
+        return;
+    }
+    
+    if(reloaded == program) {
+        return;
+    }
+    
+    cout << "Shaders reloaded." << endl;
+    GLuint replaced = program;
+    program = reloaded;
+    GLState::useProgram(program);
+    Camera::applyProgram(program);
+    ProgramCache::evict(replaced);
 }
 
+/**
+ *  The meshes never change shape, so they all go
+ *  in to one batch rather than a VAO each.
+ */
 void QuaternionDemo::prepareMeshes(void) {
-    for(auto &mesh: meshes) {
-        mesh.prepareBuffers();
+    syncEntities();
+    mesh_tree.build(entities.getWorldBounds());
+    
+    batch.build(meshes, entities.getMeshes());
+}
+
+/**
+ *  Copies world matrices from the scene graph in to the
+ *  entities, but only for the nodes that have changed.
+ *  Returns true if anything moved.
+ */
+bool QuaternionDemo::syncEntities(void) {
+    scene.update(jobs);
+    
+    for(SceneNode node: scene.changed()) {
+        entities.setWorld(node_entities[node], scene.world(node));
     }
+    
+    return !scene.changed().empty();
+}
+
+/**
+ *  Both cameras use whatever depth the target ended
+ *  up with, and lose their far plane if it is reversed.
+ */
+void QuaternionDemo::setupCameras(void) {
+    ClipDepth clip_depth = depth_target.create(gl_viewport_w, gl_viewport_h);
+    
+    for(PerspectiveCamera *camera: {&Camera::get(), &overview_camera}) {
+        camera->setClipDepth(clip_depth);
+        if(CLIP_DEPTH_REVERSED == clip_depth) {
+            camera->setFarPlane(infinite_far);
+        }
+    }
+    
+    overview_camera.setViewportSize(overview_w, overview_h);
+    overview_camera.setPosition(vec3(0.0f, 40.0f, 0.0f));
+    overview_camera.setOrientation(quat_from_axis_deg(-90.0f, 1.0f, 0.0f, 0.0f));
+}
+
+/**
+ *  Both views are culled together, and share
+ *  the world matrices written once a frame.
+ */
+void QuaternionDemo::setupViews(void) {
+    views.clear();
+    views.add(&Camera::get(), 0, 0, gl_viewport_w, gl_viewport_h);
+    
+    if(show_overview) {
+        views.add(&overview_camera,
+                  gl_viewport_w - overview_w - overview_margin,
+                  gl_viewport_h - overview_h - overview_margin,
+                  overview_w, overview_h, true);
+    }
+}
+
+/**
+ *  Nearest first, so the depth test throws away
+ *  as much as it can before the fragment shader.
+ */
+void QuaternionDemo::sortByDepth(vector<int> &visible, const vec3 &eye) {
+    const vector<AABB> &world_bounds = entities.getWorldBounds();
+    visible_depths.resize(world_bounds.size());
+    for(int i: visible) {
+        vec3 centre = aabb_centre(world_bounds[i]);
+        visible_depths[i] = length2(vec3(
+            centre.v[0] - eye.v[0],
+            centre.v[1] - eye.v[1],
+            centre.v[2] - eye.v[2]
+        ));
+    }
+    sort(begin(visible), end(visible), [this](int a, int b) {
+        return visible_depths[a] < visible_depths[b];
+    });
 }
 
 void QuaternionDemo::drawLoop(void) {
     
+    /**
+     *  Count GL calls one frame at a time, so
+     *  pressing P shows what the last frame did.
+     */
+    GLState::resetCounters();
+    
+    reloadProgram();
+    
+    /**
+     *  The keys read last frame move the camera once, by
+     *  however long that frame took. The time comes from
+     *  Input so a replay moves it the same way.
+     */
+    double now = Input::getInstance().time();
+    Camera::advance(now - last_frame_time);
+    last_frame_time = now;
+    
+    depth_target.bind();
+    GLState::viewport(0, 0, gl_viewport_w, gl_viewport_h);
+    GLState::clearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0, gl_viewport_w, gl_viewport_h);
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     
     if(GL_TRUE == GLUtilities::programReady(program)) {
-        for(auto &mesh: meshes) {
-            mesh.applyIdentityMatrix(program);
-            glBindVertexArray(mesh.getVao());
-            glDrawArrays(drawing_method, 0, mesh.pointsSize());
+        /**
+         *  Find the meshes inside the camera frustum
+         *  first and only draw the ones we can see.
+         */
+        if(syncEntities()) {
+            mesh_tree.refit(entities.getWorldBounds());
+        }
+        batch.updateWorlds(entities.getWorlds());
+        views.cull(mesh_tree);
+        
+        for(int i = 0; i < (int)views.size(); i++) {
+            RenderView &view = views.view(i);
+            sortByDepth(view.visible, view.camera->position());
+            
+            /**
+             *  Every visible mesh goes out in one draw call.
+             */
+            views.apply(i, program);
+            batch.draw(program, drawing_method, view.visible);
         }
+        batch.endFrame();
     }
     
+    depth_target.resolve();
     glfwPollEvents();
+    Input::getInstance().dispatch();
     glfwSwapBuffers(window);
 }
 
+/**
+ *  Uses the real clock, not Input's, since this is
+ *  what a replay is for comparing between builds.
+ */
+void QuaternionDemo::timeFrame(void) {
+    double clock = glfwGetTime();
+    
+    if(timing_replay) {
+        frame_times.push_back((clock - last_frame_clock) * 1000.0);
+        
+        if(!Input::getInstance().replaying()) {
+            printFrameTimes();
+            timing_replay = false;
+            glfwSetWindowShouldClose(window, 1);
+        }
+    }
+    
+    last_frame_clock = clock;
+}
+
+void QuaternionDemo::printFrameTimes(void) {
+    if(frame_times.empty()) {
+        return;
+    }
+    
+    vector<double> sorted = frame_times;
+    sort(begin(sorted), end(sorted));
+    auto percentile = [&sorted](double p) {
+        return sorted[(size_t)(p * (sorted.size() - 1))];
+    };
+    
+    cout << "Replayed " << sorted.size() << " frames (ms):" << endl;
+    cout << "min: \t" << sorted.front() << endl;
+    cout << "p50: \t" << percentile(0.5) << endl;
+    cout << "p95: \t" << percentile(0.95) << endl;
+    cout << "p99: \t" << percentile(0.99) << endl;
+    cout << "max: \t" << sorted.back() << endl;
+}
+
 void QuaternionDemo::keyActionListener(void) {
     
     if(!window) {
         return;
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_ESCAPE)) {
+    const Input &input = Input::getInstance();
+    
+    if(input.isKeyDown(GLFW_KEY_ESCAPE)) {
         glfwSetWindowShouldClose(window, 1);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_A)) {
+    if(input.isKeyDown(GLFW_KEY_A)) {
         Camera::update(MOVE_LEFT);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_D)) {
+    if(input.isKeyDown(GLFW_KEY_D)) {
         Camera::update(MOVE_RIGHT);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_W)) {
+    if(input.isKeyDown(GLFW_KEY_W)) {
         Camera::update(MOVE_FORWARD);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_S)) {
+    if(input.isKeyDown(GLFW_KEY_S)) {
         Camera::update(MOVE_BACKWARD);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_Q)) {
+    if(input.isKeyDown(GLFW_KEY_Q)) {
         Camera::update(MOVE_UP);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_E)) {
+    if(input.isKeyDown(GLFW_KEY_E)) {
         Camera::update(MOVE_DOWN);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_UP)) {
+    if(input.isKeyDown(GLFW_KEY_UP)) {
         Camera::update(PITCH_UP);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_DOWN)) {
+    if(input.isKeyDown(GLFW_KEY_DOWN)) {
         Camera::update(PITCH_DOWN);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_LEFT)) {
+    if(input.isKeyDown(GLFW_KEY_LEFT)) {
         Camera::update(YAW_LEFT);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_RIGHT)) {
+    if(input.isKeyDown(GLFW_KEY_RIGHT)) {
         Camera::update(YAW_RIGHT);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_Z)) {
+    if(input.isKeyDown(GLFW_KEY_Z)) {
         Camera::update(ROLL_LEFT);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_C)) {
+    if(input.isKeyDown(GLFW_KEY_C)) {
         Camera::update(ROLL_RIGHT);
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_MINUS)) {
+    /**
+     *  Only on the press, not every frame it is held.
+     */
+    if(input.wasKeyPressed(GLFW_KEY_O)) {
+        show_overview = !show_overview;
+        setupViews();
+    }
+    
+    if(input.isKeyDown(GLFW_KEY_P)) {
+        glfwSetWindowTitle(window, GLState::repr().c_str());
+    }
+    
+    if(input.isKeyDown(GLFW_KEY_MINUS)) {
         Camera::updateFov(-0.5f);
         glfwSetWindowTitle(window, Camera::repr().c_str());
     }
     
-    if(GLFW_PRESS == glfwGetKey(window, GLFW_KEY_EQUAL)) {
+    if(input.isKeyDown(GLFW_KEY_EQUAL)) {
         Camera::updateFov(0.5f);
         glfwSetWindowTitle(window, Camera::repr().c_str());
     }
 }
 
-void QuaternionDemo::addMesh(Mesh mesh, const Position position, const Rotation rotation) {
+/**
+ *  Input only calls this on a press.
+ */
+void QuaternionDemo::mouseDown(int button, int, int) {
+    if(GLFW_MOUSE_BUTTON_LEFT == button) {
+        pickMesh();
+    }
+}
+
+/**
+ *  Fire a ray from the camera through the mouse pointer
+ *  and show the nearest mesh it hits in the window title.
+ */
+void QuaternionDemo::pickMesh(void) {
+    Position pointer = Input::getInstance().position();
+    Ray ray = Camera::screenRay(pointer.px, pointer.py);
     
-    mesh.getMatrices()->rotateTo(ROTATE_X, rotation.rx);
-    mesh.getMatrices()->rotateTo(ROTATE_Y, rotation.ry);
-    mesh.getMatrices()->rotateTo(ROTATE_Z, rotation.rz);
+    BVHHit hit;
+    if(mesh_tree.raycast(ray, 1000.0f, hit)) {
+        string title = "Picked mesh: " + to_string(entities.getMeshes()[hit.item]);
+        glfwSetWindowTitle(window, title.c_str());
+    }
+    else {
+        glfwSetWindowTitle(window, "Quaternion Demo");
+    }
+}
+
+/**
+ *  Position and rotation are relative to the parent
+ *  node, if there is one, and rotations are in degrees.
+ */
+SceneNode QuaternionDemo::addMesh(Mesh mesh, const Position position, const Rotation rotation, SceneNode parent) {
+    QuaternionDemo &demo = getInstance();
+    
+    SceneNode node = demo.scene.create(parent);
+    demo.scene.setPosition(node, vec3(position.px, position.py, position.pz));
+    demo.scene.setRotation(node, quat_from_euler_deg(rotation.rx, rotation.ry, rotation.rz));
+    
+    Entity entity = demo.entities.create();
+    demo.entities.setMesh(entity, (int)demo.meshes.size());
+    demo.entities.setBounds(entity, mesh.getBounds());
     
-    mesh.getMatrices()->translateTo(TRANSLATE_X, position.px);
-    mesh.getMatrices()->translateTo(TRANSLATE_Y, position.py);
-    mesh.getMatrices()->translateTo(TRANSLATE_Z, position.pz);
+    if(demo.node_entities.size() <= (size_t)node) {
+        demo.node_entities.resize(node + 1);
+    }
+    demo.node_entities[node] = entity;
+    demo.meshes.push_back(mesh);
     
-    getInstance().meshes.push_back(mesh);
+    return node;
 }
 
 int QuaternionDemo::start() {
     
     try {
         window = GLUtilities::setupWindow(gl_viewport_w, gl_viewport_h, "Quaternion Demo");
+        
+        /**
+         *  Mouse and key input is routed through Input, so we
+         *  can pick meshes by clicking them and check keys
+         *  without asking GLFW for each one.
+         */
+        glfwSetMouseButtonCallback(window, &Input::glfwMouseButtonCallback);
+        glfwSetCursorPosCallback(window, &Input::glfwMouseMoveCallback);
+        glfwSetKeyCallback(window, &Input::glfwKeyCallback);
+        Input::getInstance().onMouseDown(std::bind(&QuaternionDemo::mouseDown, this, _1, _2, _3));
     }
     catch(exception &e) {
         cout << e.what();
@@ -156,17 +431,19 @@ int QuaternionDemo::start() {
     }
     
     /**
-     *  Prepare the mesh buffers for all meshes
+     *  Load the vertex and fragment shaders and start compiling
+     *  and linking them, then prepare the mesh buffers for all
+     *  meshes while that happens, and finally pick up the
+     *  program so we can use it.
      */
+    createProgram();
     prepareMeshes();
     
-    /**
-     *  Load the vertex and fragment shaders, compile them,
-     *  link them and then assign them to the program member
-     *  variable so we can use it.
-     */
-    createProgram();
-    glUseProgram(program);
+    program = programs.program(program_index);
+    GLParams::print_program_info_log(program);
+    GLState::useProgram(program);
+    
+    setupCameras();
     
     if(GLUtilities::programReady(program)) {
         
@@ -182,11 +459,32 @@ int QuaternionDemo::start() {
         Camera::create();
         cout << Camera::repr() << endl;        
     }
+    setupViews();
+    
+    /**
+     *  One dispatch before the first frame, so the first
+     *  frame's time is recorded (or replayed) as well.
+     */
+    Input::getInstance().dispatch();
+    last_frame_time = Input::getInstance().time();
+    last_frame_clock = glfwGetTime();
+    timing_replay = Input::getInstance().replaying();
     
     while(!glfwWindowShouldClose(window)) {
         drawLoop();
         keyActionListener();
+        timeFrame();
+    }
+    
+    /**
+     *  Give the meshes' ranges back while
+     *  the context they live in is still here.
+     */
+    batch.release();
+    for(auto &mesh: meshes) {
+        mesh.releaseBuffers();
     }
+    MeshBuffers::release();
     
     return 0;
 }
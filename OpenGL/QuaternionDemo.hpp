@@ -9,12 +9,22 @@
 #ifndef QuaternionDemo_hpp
 #define QuaternionDemo_hpp
 
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <vector>
 #include "Structs.h"
 #include "Mesh.hpp"
+#include "BVH.hpp"
+#include "SceneGraph.hpp"
+#include "EntityStore.hpp"
+#include "JobSystem.hpp"
+#include "StaticBatch.hpp"
+#include "ProgramBatch.hpp"
+#include "FileWatcher.hpp"
+#include "PerspectiveCamera.hpp"
+#include "RenderView.hpp"
+#include "DepthTarget.hpp"
 
 #define one_deg_in_rad (2.0 * M_PI) / 360.0f
 
@@ -27,21 +37,89 @@ private:
     void operator=(QuaternionDemo const &);
     
     GLuint program;
+    ProgramBatch programs;
+    int program_index = -1;
+    
+    /**
+     *  Shader files are watched while the demo runs,
+     *  and the program rebuilt when they change.
+     */
+    FileWatcher shader_files;
     GLFWwindow *window;
     GLenum drawing_method = GL_TRIANGLES;
+    double last_frame_time = 0.0;
+    
+    /**
+     *  While replaying recorded input, how long each
+     *  frame really took, printed when the replay ends.
+     */
+    bool timing_replay = false;
+    double last_frame_clock = 0.0;
+    std::vector<double> frame_times;
         
     std::vector<Mesh> meshes;
     
+    /**
+     *  Each mesh that was added is an entity with a node in
+     *  the scene graph, which works out its world matrix. The
+     *  entity store keeps what the per frame passes need (world
+     *  matrices, bounds and which mesh to draw) packed together,
+     *  away from the geometry.
+     */
+    SceneGraph scene;
+    EntityStore entities;
+    std::vector<Entity> node_entities;
+    
+    /**
+     *  Per frame work like updating the scene graph
+     *  is split between the workers in here.
+     */
+    JobSystem jobs;
+    
+    /**
+     *  Tree over the world bounds of the entities, used to
+     *  find the visible ones each frame and to pick them
+     *  with the mouse.
+     */
+    BVH mesh_tree;
+    std::vector<float> visible_depths;
+    StaticBatch batch;
+    
+    /**
+     *  The scene is drawn through the main camera and, in the
+     *  corner, one looking straight down on it. O turns the
+     *  overview on and off.
+     */
+    PerspectiveCamera overview_camera;
+    RenderViews views;
+    bool show_overview = true;
+    
+    /**
+     *  Reversed depth with no far plane where the
+     *  driver supports it, see DepthTarget.
+     */
+    DepthTarget depth_target;
+    
     void createProgram(void);
+    void watchShaders(void);
+    void reloadProgram(void);
     void prepareMeshes(void);
+    bool syncEntities(void);
+    void setupCameras(void);
+    void setupViews(void);
+    void sortByDepth(std::vector<int> &visible, const vec3 &eye);
     void applyQuaternion(void);
     void drawLoop(void);
     void keyActionListener(void);
+    void mouseDown(int button, int action, int mods);
+    void pickMesh(void);
+    void timeFrame(void);
+    void printFrameTimes(void);
     int start(void);
 
 public:
     static QuaternionDemo& getInstance();
-    static void addMesh(Mesh mesh, const Position position, const Rotation rotation);
+    static SceneNode addMesh(Mesh mesh, const Position position, const Rotation rotation, SceneNode parent = no_scene_node);
     static int run(void);
 };
 
@@ -0,0 +1,419 @@
+//
+//  RangeAllocator.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 28/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "RangeAllocator.hpp"
+#include <algorithm>
+
+using namespace std;
+
+static int highest_bit(uint64_t x) {
+    int bit = -1;
+    while(x) {
+        x >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+static int lowest_bit(uint64_t x) {
+    int bit = 0;
+    while(!(x & 1)) {
+        x >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+/**
+ *  The first level is the power of two the size falls under,
+ *  and the second level splits that in to sl_count equal steps.
+ *  Sizes below sl_count all go in the first row.
+ */
+static void mapping(size_t size, int sl_bits, int &fl, int &sl) {
+    int top = highest_bit(size);
+    if(top < sl_bits) {
+        fl = 0;
+        sl = (int)size;
+    }
+    else {
+        fl = top - sl_bits + 1;
+        sl = (int)((size >> (top - sl_bits)) & ((1 << sl_bits) - 1));
+    }
+}
+
+RangeAllocator::RangeAllocator(size_t capacity) {
+    reset(capacity);
+}
+
+void RangeAllocator::reset(size_t _capacity) {
+    blocks.clear();
+    unused_blocks.clear();
+    fl_bitmap = 0;
+    for(int fl = 0; fl < fl_count; fl++) {
+        sl_bitmap[fl] = 0;
+        for(int sl = 0; sl < sl_count; sl++) {
+            heads[fl][sl] = -1;
+        }
+    }
+    
+    capacity = _capacity;
+    used = 0;
+    allocations = 0;
+    first_phys = -1;
+    
+    if(capacity > 0) {
+        int index = newBlock();
+        blocks[index].offset = 0;
+        blocks[index].size = capacity;
+        first_phys = index;
+        insertFree(index);
+    }
+}
+
+int RangeAllocator::newBlock(void) {
+    int index;
+    if(!unused_blocks.empty()) {
+        index = unused_blocks.back();
+        unused_blocks.pop_back();
+    }
+    else {
+        index = (int)blocks.size();
+        blocks.push_back(Block());
+        blocks[index].generation = 0;
+    }
+    
+    Block &block = blocks[index];
+    block.offset = 0;
+    block.size = 0;
+    block.prev_phys = -1;
+    block.next_phys = -1;
+    block.prev_free = -1;
+    block.next_free = -1;
+    block.free = false;
+    block.in_use = true;
+    return index;
+}
+
+/**
+ *  The generation is kept when a block is reused,
+ *  so handles from before never match it again.
+ */
+void RangeAllocator::releaseBlock(int index) {
+    blocks[index].in_use = false;
+    blocks[index].generation++;
+    unused_blocks.push_back(index);
+}
+
+RangeHandle RangeAllocator::handle(int index) const {
+    return ((RangeHandle)blocks[index].generation << 32) | (RangeHandle)(uint32_t)index;
+}
+
+/**
+ *  The block a handle points at, or -1 if the
+ *  handle is stale or was never handed out.
+ */
+int RangeAllocator::blockIndex(RangeHandle handle) const {
+    if(no_range == handle) {
+        return -1;
+    }
+    
+    size_t index = (size_t)(handle & 0xffffffff);
+    uint32_t generation = (uint32_t)(handle >> 32);
+    if(index >= blocks.size()) {
+        return -1;
+    }
+    
+    const Block &block = blocks[index];
+    if(!block.in_use || block.free || block.generation != generation) {
+        return -1;
+    }
+    return (int)index;
+}
+
+void RangeAllocator::insertFree(int index) {
+    Block &block = blocks[index];
+    int fl, sl;
+    mapping(block.size, sl_bits, fl, sl);
+    
+    block.free = true;
+    block.prev_free = -1;
+    block.next_free = heads[fl][sl];
+    if(block.next_free != -1) {
+        blocks[block.next_free].prev_free = index;
+    }
+    heads[fl][sl] = index;
+    
+    fl_bitmap |= (uint64_t)1 << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+void RangeAllocator::removeFree(int index) {
+    Block &block = blocks[index];
+    int fl, sl;
+    mapping(block.size, sl_bits, fl, sl);
+    
+    if(block.prev_free != -1) {
+        blocks[block.prev_free].next_free = block.next_free;
+    }
+    else {
+        heads[fl][sl] = block.next_free;
+    }
+    if(block.next_free != -1) {
+        blocks[block.next_free].prev_free = block.prev_free;
+    }
+    
+    if(heads[fl][sl] == -1) {
+        sl_bitmap[fl] &= ~(1u << sl);
+        if(!sl_bitmap[fl]) {
+            fl_bitmap &= ~((uint64_t)1 << fl);
+        }
+    }
+    
+    block.free = false;
+    block.prev_free = -1;
+    block.next_free = -1;
+}
+
+/**
+ *  Rounds the size up to the next list boundary first, so
+ *  every block in the list we land on is big enough and we
+ *  never have to walk along a list looking for one.
+ *
+ *  That skips the list the size itself falls in, which can
+ *  still hold a block big enough (like one that fits exactly),
+ *  so that list is only walked when nothing bigger is free.
+ */
+int RangeAllocator::findFree(size_t size) {
+    size_t rounded = size;
+    int top = highest_bit(size);
+    if(top >= sl_bits) {
+        size_t round = ((size_t)1 << (top - sl_bits)) - 1;
+        rounded += round;
+    }
+    
+    int fl, sl;
+    mapping(rounded, sl_bits, fl, sl);
+    if(fl < fl_count) {
+        uint32_t sl_map = sl_bitmap[fl] & (~0u << sl);
+        uint64_t fl_map = fl + 1 < fl_count ? fl_bitmap & (~(uint64_t)0 << (fl + 1)) : 0;
+        if(sl_map || fl_map) {
+            if(!sl_map) {
+                fl = lowest_bit(fl_map);
+                sl_map = sl_bitmap[fl];
+            }
+            sl = lowest_bit(sl_map);
+            return heads[fl][sl];
+        }
+    }
+    
+    mapping(size, sl_bits, fl, sl);
+    if(fl >= fl_count) {
+        return -1;
+    }
+    for(int index = heads[fl][sl]; index != -1; index = blocks[index].next_free) {
+        if(blocks[index].size >= size) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+RangeHandle RangeAllocator::allocate(size_t size) {
+    size = max(size, (size_t)1);
+    
+    int index = findFree(size);
+    if(index == -1) {
+        return no_range;
+    }
+    removeFree(index);
+    
+    /**
+     *  Give back whatever is left over.
+     */
+    if(blocks[index].size > size) {
+        int rest = newBlock();
+        Block &block = blocks[index];
+        Block &remainder = blocks[rest];
+        remainder.offset = block.offset + size;
+        remainder.size = block.size - size;
+        remainder.prev_phys = index;
+        remainder.next_phys = block.next_phys;
+        if(block.next_phys != -1) {
+            blocks[block.next_phys].prev_phys = rest;
+        }
+        block.next_phys = rest;
+        block.size = size;
+        insertFree(rest);
+    }
+    
+    used += blocks[index].size;
+    allocations++;
+    return handle(index);
+}
+
+/**
+ *  Merges the block with free neighbours on either
+ *  side, so free space never ends up in pieces that
+ *  could have been one.
+ */
+void RangeAllocator::free(RangeHandle handle) {
+    int index = blockIndex(handle);
+    if(index == -1) {
+        return;
+    }
+    
+    used -= blocks[index].size;
+    allocations--;
+    blocks[index].generation++;
+    
+    int next = blocks[index].next_phys;
+    if(next != -1 && blocks[next].free) {
+        removeFree(next);
+        blocks[index].size += blocks[next].size;
+        blocks[index].next_phys = blocks[next].next_phys;
+        if(blocks[next].next_phys != -1) {
+            blocks[blocks[next].next_phys].prev_phys = index;
+        }
+        releaseBlock(next);
+    }
+    
+    int prev = blocks[index].prev_phys;
+    if(prev != -1 && blocks[prev].free) {
+        removeFree(prev);
+        blocks[prev].size += blocks[index].size;
+        blocks[prev].next_phys = blocks[index].next_phys;
+        if(blocks[index].next_phys != -1) {
+            blocks[blocks[index].next_phys].prev_phys = prev;
+        }
+        releaseBlock(index);
+        index = prev;
+    }
+    
+    insertFree(index);
+}
+
+bool RangeAllocator::valid(RangeHandle handle) const {
+    return blockIndex(handle) != -1;
+}
+
+size_t RangeAllocator::offset(RangeHandle handle) const {
+    int index = blockIndex(handle);
+    return index == -1 ? 0 : blocks[index].offset;
+}
+
+size_t RangeAllocator::size(RangeHandle handle) const {
+    int index = blockIndex(handle);
+    return index == -1 ? 0 : blocks[index].size;
+}
+
+void RangeAllocator::grow(size_t new_capacity) {
+    if(new_capacity <= capacity) {
+        return;
+    }
+    
+    size_t extra = new_capacity - capacity;
+    
+    int last = first_phys;
+    while(last != -1 && blocks[last].next_phys != -1) {
+        last = blocks[last].next_phys;
+    }
+    
+    if(last != -1 && blocks[last].free) {
+        removeFree(last);
+        blocks[last].size += extra;
+        insertFree(last);
+    }
+    else {
+        int index = newBlock();
+        blocks[index].offset = capacity;
+        blocks[index].size = extra;
+        blocks[index].prev_phys = last;
+        if(last != -1) {
+            blocks[last].next_phys = index;
+        }
+        else {
+            first_phys = index;
+        }
+        insertFree(index);
+    }
+    
+    capacity = new_capacity;
+}
+
+vector<RangeMove> RangeAllocator::defragment(void) {
+    vector<RangeMove> moves;
+    vector<int> live;
+    
+    for(int index = first_phys; index != -1; index = blocks[index].next_phys) {
+        if(blocks[index].free) {
+            removeFree(index);
+            releaseBlock(index);
+        }
+        else {
+            live.push_back(index);
+        }
+    }
+    
+    size_t offset = 0;
+    int prev = -1;
+    first_phys = -1;
+    
+    for(int index: live) {
+        Block &block = blocks[index];
+        if(block.offset != offset) {
+            moves.push_back({handle(index), block.offset, offset, block.size});
+            block.offset = offset;
+        }
+        block.prev_phys = prev;
+        block.next_phys = -1;
+        if(prev != -1) {
+            blocks[prev].next_phys = index;
+        }
+        else {
+            first_phys = index;
+        }
+        offset += block.size;
+        prev = index;
+    }
+    
+    if(offset < capacity) {
+        int index = newBlock();
+        blocks[index].offset = offset;
+        blocks[index].size = capacity - offset;
+        blocks[index].prev_phys = prev;
+        if(prev != -1) {
+            blocks[prev].next_phys = index;
+        }
+        else {
+            first_phys = index;
+        }
+        insertFree(index);
+    }
+    
+    return moves;
+}
+
+RangeStats RangeAllocator::stats(void) const {
+    RangeStats stats;
+    stats.capacity = capacity;
+    stats.used = used;
+    stats.free = capacity - used;
+    stats.largest_free = 0;
+    stats.allocations = allocations;
+    stats.free_blocks = 0;
+    
+    for(int index = first_phys; index != -1; index = blocks[index].next_phys) {
+        if(blocks[index].free) {
+            stats.free_blocks++;
+            stats.largest_free = max(stats.largest_free, blocks[index].size);
+        }
+    }
+    
+    stats.fragmentation = stats.free > 0 ? 1.0f - (float)stats.largest_free / (float)stats.free : 0.0f;
+    return stats;
+}
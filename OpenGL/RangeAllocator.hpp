@@ -0,0 +1,149 @@
+//
+//  RangeAllocator.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 28/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef RangeAllocator_hpp
+#define RangeAllocator_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  Handle to an allocated range. It stays the same
+ *  when defragment moves the range somewhere else.
+ *
+ *  The low 32 bits are the block the range lives in and the
+ *  high 32 bits that block's generation, which goes up every
+ *  time the range is freed. A handle kept after its range was
+ *  freed no longer matches, so it can't free or look up a
+ *  range that has since been handed to someone else.
+ */
+typedef uint64_t RangeHandle;
+
+const RangeHandle no_range = ~(RangeHandle)0;
+
+/**
+ *  A range that defragment moved, so whatever
+ *  holds the real data can copy it across.
+ */
+struct RangeMove {
+    RangeHandle handle;
+    size_t from;
+    size_t to;
+    size_t size;
+};
+
+struct RangeStats {
+    size_t capacity;
+    size_t used;
+    size_t free;
+    size_t largest_free;
+    size_t allocations;
+    size_t free_blocks;
+    
+    /**
+     *  0 when all the free space is in one piece, heading
+     *  towards 1 as it gets split up in to little gaps.
+     */
+    float fragmentation;
+};
+
+/**
+ *  Hands out ranges of some space that lives elsewhere (like
+ *  a GL buffer) without touching it, so it works the same with
+ *  or without a GPU. Sizes and offsets are in whatever units the
+ *  caller likes, such as bytes or vertices.
+ *
+ *  Uses two level segregated fit: free blocks are kept in lists
+ *  by size, with bitmaps saying which lists have anything in
+ *  them, so finding, splitting and merging blocks takes the
+ *  same time however many there are.
+ */
+class RangeAllocator {
+
+private:
+    struct Block {
+        size_t offset;
+        size_t size;
+        int prev_phys;
+        int next_phys;
+        int prev_free;
+        int next_free;
+        uint32_t generation;
+        bool free;
+        bool in_use;
+    };
+    
+    static const int sl_bits = 4;
+    static const int sl_count = 1 << sl_bits;
+    static const int fl_count = 64;
+    
+    std::vector<Block> blocks;
+    std::vector<int> unused_blocks;
+    
+    uint64_t fl_bitmap;
+    uint32_t sl_bitmap[fl_count];
+    int heads[fl_count][sl_count];
+    
+    int first_phys;
+    size_t capacity;
+    size_t used;
+    size_t allocations;
+    
+    int newBlock(void);
+    void releaseBlock(int index);
+    void insertFree(int index);
+    void removeFree(int index);
+    int findFree(size_t size);
+    void reset(size_t capacity);
+    
+    RangeHandle handle(int index) const;
+    int blockIndex(RangeHandle handle) const;
+
+public:
+    explicit RangeAllocator(size_t capacity = 0);
+    
+    /**
+     *  Returns no_range if there is no free block big enough.
+     */
+    RangeHandle allocate(size_t size);
+    
+    /**
+     *  Does nothing for no_range or a handle
+     *  whose range was already freed.
+     */
+    void free(RangeHandle handle);
+    
+    /**
+     *  Whether the handle is for a range that is still allocated.
+     */
+    bool valid(RangeHandle handle) const;
+    
+    /**
+     *  Both are 0 for a handle that is not valid.
+     */
+    size_t offset(RangeHandle handle) const;
+    size_t size(RangeHandle handle) const;
+    
+    /**
+     *  Adds space to the end.
+     */
+    void grow(size_t new_capacity);
+    
+    /**
+     *  Packs every range down to the start, leaving all the free
+     *  space in one block at the end. Returns what moved, ordered
+     *  by destination, so copying them in order never writes over
+     *  data that has not been copied yet.
+     */
+    std::vector<RangeMove> defragment(void);
+    
+    RangeStats stats(void) const;
+};
+
+#endif /* RangeAllocator_hpp */
@@ -0,0 +1,83 @@
+//
+//  RenderView.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 04/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "RenderView.hpp"
+#include <algorithm>
+#include "GLState.hpp"
+
+using namespace std;
+
+RenderViews::RenderViews() {}
+
+int RenderViews::add(const PerspectiveCamera *camera, GLint x, GLint y, GLsizei w, GLsizei h, bool clear) {
+    RenderView view;
+    view.camera = camera;
+    view.x = x;
+    view.y = y;
+    view.w = w;
+    view.h = h;
+    view.clear = clear;
+    views.push_back(view);
+    return (int)views.size() - 1;
+}
+
+void RenderViews::clear(void) {
+    views.clear();
+}
+
+size_t RenderViews::size(void) const {
+    return views.size();
+}
+
+RenderView& RenderViews::view(int index) {
+    return views[index];
+}
+
+/**
+ *  The tree can only cull so many frusta in one walk, so
+ *  any more views than that are done in a second walk.
+ */
+void RenderViews::cull(const BVH &tree) {
+    for(size_t first = 0; first < views.size(); first += bvh_max_frusta) {
+        size_t last = min(views.size(), first + bvh_max_frusta);
+        
+        frustums.clear();
+        for(size_t i = first; i < last; i++) {
+            frustums.push_back(views[i].camera->frustum());
+        }
+        
+        tree.cull(frustums, culled);
+        
+        for(size_t i = first; i < last; i++) {
+            views[i].visible.swap(culled[i - first]);
+        }
+    }
+}
+
+void RenderViews::apply(int index, GLuint program) {
+    const RenderView &view = views[index];
+    
+    GLState::viewport(view.x, view.y, view.w, view.h);
+    
+    if(view.clear) {
+        GLState::enable(GL_SCISSOR_TEST);
+        glScissor(view.x, view.y, view.w, view.h);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GLState::disable(GL_SCISSOR_TEST);
+    }
+    
+    if(matrix_program != program) {
+        matrix_program = program;
+        view_location = glGetUniformLocation(program, "view");
+        proj_location = glGetUniformLocation(program, "projection");
+    }
+    
+    GLState::useProgram(program);
+    glUniformMatrix4fv(view_location, 1, GL_FALSE, view.camera->view().m);
+    glUniformMatrix4fv(proj_location, 1, GL_FALSE, view.camera->projection().m);
+}
@@ -0,0 +1,79 @@
+//
+//  RenderView.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 04/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef RenderView_hpp
+#define RenderView_hpp
+
+#include "GLPlatform.h"
+#include <vector>
+#include "PerspectiveCamera.hpp"
+#include "BVH.hpp"
+
+/**
+ *  One camera drawing in to one part of the window. If clear
+ *  is set the rectangle is cleared before it is drawn in to,
+ *  which is what a view laid over another one needs.
+ */
+struct RenderView {
+    const PerspectiveCamera *camera;
+    GLint x;
+    GLint y;
+    GLsizei w;
+    GLsizei h;
+    bool clear;
+    
+    /**
+     *  Filled in by RenderViews::cull.
+     */
+    std::vector<int> visible;
+};
+
+/**
+ *  Draws one scene through any number of cameras (split screen,
+ *  picture in picture, mirrors). Every view is culled in the
+ *  same walk of the BVH, so where the frusta overlap the nodes
+ *  are only visited once, then each view is drawn in turn with
+ *  its own viewport and matrices.
+ */
+class RenderViews {
+
+private:
+    std::vector<RenderView> views;
+    std::vector<Frustum> frustums;
+    std::vector<std::vector<int>> culled;
+    
+    GLuint matrix_program = 0;
+    GLint view_location = -1;
+    GLint proj_location = -1;
+
+public:
+    RenderViews();
+    
+    /**
+     *  The camera is not copied, so it has to
+     *  outlive the view. Returns the view's index.
+     */
+    int add(const PerspectiveCamera *camera, GLint x, GLint y, GLsizei w, GLsizei h, bool clear = false);
+    void clear(void);
+    
+    size_t size(void) const;
+    RenderView& view(int index);
+    
+    /**
+     *  Fills in the visible items of every view.
+     */
+    void cull(const BVH &tree);
+    
+    /**
+     *  Sets the viewport (clearing it if asked) and sends the
+     *  view's matrices to the program, ready to draw.
+     */
+    void apply(int index, GLuint program);
+};
+
+#endif /* RenderView_hpp */
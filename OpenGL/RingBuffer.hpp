@@ -0,0 +1,133 @@
+//
+//  RingBuffer.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 06/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef RingBuffer_hpp
+#define RingBuffer_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+/**
+ *  A fixed size queue for exactly one thread pushing and one
+ *  thread popping. With only one writer on each end there is
+ *  nothing to fight over, so there are no compare and swaps,
+ *  just a load and a store of the head and tail. That makes it
+ *  cheaper than LockFreeQueue when the threads are known.
+ *
+ *  The capacity is rounded up to a power of two.
+ */
+template<typename T>
+class RingBuffer {
+
+private:
+    std::unique_ptr<T[]> values;
+    size_t mask;
+    
+    /**
+     *  Kept on their own cache lines so the two
+     *  threads don't keep taking them from each other.
+     */
+    alignas(64) std::atomic<size_t> tail;
+    alignas(64) std::atomic<size_t> head;
+    
+    RingBuffer(const RingBuffer &);
+    void operator=(const RingBuffer &);
+
+public:
+    /**
+     *  Plain new only lines things up to 16 bytes before
+     *  C++17, so rings made on the heap ask for 64.
+     */
+    static void* operator new(size_t size) {
+        void *memory = nullptr;
+        if(0 != posix_memalign(&memory, alignof(RingBuffer), size)) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+    
+    static void operator delete(void *memory) {
+        free(memory);
+    }
+    
+    explicit RingBuffer(size_t capacity) : tail(0), head(0) {
+        size_t size = 2;
+        while(size < capacity) {
+            size <<= 1;
+        }
+        
+        values.reset(new T[size]);
+        mask = size - 1;
+    }
+    
+    /**
+     *  Only from the pushing thread. Returns
+     *  false if the ring is full.
+     */
+    bool push(const T &value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if(position - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        
+        values[position & mask] = value;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     *  Only from the popping thread. Returns
+     *  false if the ring is empty.
+     */
+    bool pop(T &value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if(position == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        
+        value = values[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     *  Only from the popping thread. Takes up to count values
+     *  at once, handing back the space with a single store, and
+     *  returns how many there were.
+     */
+    size_t pop(T *out, size_t count) {
+        size_t position = head.load(std::memory_order_relaxed);
+        size_t available = tail.load(std::memory_order_acquire) - position;
+        if(count > available) {
+            count = available;
+        }
+        
+        for(size_t i = 0; i < count; i++) {
+            out[i] = values[(position + i) & mask];
+        }
+        head.store(position + count, std::memory_order_release);
+        return count;
+    }
+    
+    /**
+     *  Only from the popping thread. How many values are
+     *  waiting, though more may be pushed straight after.
+     */
+    size_t size(void) const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_relaxed);
+    }
+    
+    size_t capacity(void) const {
+        return mask + 1;
+    }
+};
+
+#endif /* RingBuffer_hpp */
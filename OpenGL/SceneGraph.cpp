@@ -0,0 +1,279 @@
+//
+//  SceneGraph.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 22/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "SceneGraph.hpp"
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ *  Fewer nodes than this are not worth handing to another thread.
+ */
+#define scene_graph_grain 256
+
+Transform::Transform() {
+    position = vec3(0.0f, 0.0f, 0.0f);
+    rotation.q[0] = 1.0f;
+    rotation.q[1] = 0.0f;
+    rotation.q[2] = 0.0f;
+    rotation.q[3] = 0.0f;
+    scale = vec3(1.0f, 1.0f, 1.0f);
+}
+
+SceneGraph::SceneGraph() {}
+
+size_t SceneGraph::size(void) const {
+    return ids.size();
+}
+
+SceneNode SceneGraph::create(SceneNode parent) {
+    int parent_slot = parent == no_scene_node ? -1 : slots[parent];
+    int depth = parent_slot == -1 ? 0 : depths[parent_slot] + 1;
+    
+    SceneNode node = (SceneNode)slots.size();
+    int slot = (int)ids.size();
+    
+    /**
+     *  Adding to the end keeps parents before children, but
+     *  a node shallower than the last one breaks the breadth
+     *  first order, so the arrays get sorted out on update.
+     */
+    if(!depths.empty() && depth < depths.back()) {
+        needs_layout = true;
+    }
+    
+    slots.push_back(slot);
+    ids.push_back(node);
+    parents.push_back(parent_slot);
+    depths.push_back(depth);
+    locals.push_back(Transform());
+    worlds.push_back(identity_mat4());
+    dirty.push_back(0);
+    markDirty(slot);
+    
+    return node;
+}
+
+bool SceneGraph::setParent(SceneNode node, SceneNode parent) {
+    int slot = slots[node];
+    int parent_slot = parent == no_scene_node ? -1 : slots[parent];
+    
+    for(int s = parent_slot; s != -1; s = parents[s]) {
+        if(s == slot) {
+            return false;
+        }
+    }
+    
+    parents[slot] = parent_slot;
+    needs_layout = true;
+    markDirty(slot);
+    return true;
+}
+
+SceneNode SceneGraph::parent(SceneNode node) const {
+    int parent_slot = parents[slots[node]];
+    return parent_slot == -1 ? no_scene_node : ids[parent_slot];
+}
+
+void SceneGraph::markDirty(int slot) {
+    dirty[slot] = 1;
+    if(first_dirty == -1 || slot < first_dirty) {
+        first_dirty = slot;
+    }
+}
+
+void SceneGraph::setLocal(SceneNode node, const Transform &transform) {
+    int slot = slots[node];
+    locals[slot] = transform;
+    markDirty(slot);
+}
+
+void SceneGraph::setPosition(SceneNode node, const vec3 &position) {
+    int slot = slots[node];
+    locals[slot].position = position;
+    markDirty(slot);
+}
+
+void SceneGraph::setRotation(SceneNode node, const versor &rotation) {
+    int slot = slots[node];
+    locals[slot].rotation = rotation;
+    markDirty(slot);
+}
+
+void SceneGraph::setScale(SceneNode node, const vec3 &scale) {
+    int slot = slots[node];
+    locals[slot].scale = scale;
+    markDirty(slot);
+}
+
+const Transform& SceneGraph::local(SceneNode node) const {
+    return locals[slots[node]];
+}
+
+const mat4& SceneGraph::world(SceneNode node) const {
+    return worlds[slots[node]];
+}
+
+/**
+ *  Walks the tree breadth first from the roots and moves
+ *  everything in to that order, so siblings end up next to
+ *  each other and each level follows the one above it.
+ */
+void SceneGraph::layout(void) {
+    const int count = (int)ids.size();
+    
+    vector<int> child_start(count + 1, 0);
+    vector<int> children(count);
+    vector<int> order;
+    order.reserve(count);
+    
+    for(int slot = 0; slot < count; slot++) {
+        if(parents[slot] == -1) {
+            order.push_back(slot);
+        }
+        else {
+            child_start[parents[slot] + 1]++;
+        }
+    }
+    for(int slot = 0; slot < count; slot++) {
+        child_start[slot + 1] += child_start[slot];
+    }
+    vector<int> fill(begin(child_start), end(child_start) - 1);
+    for(int slot = 0; slot < count; slot++) {
+        if(parents[slot] != -1) {
+            children[fill[parents[slot]]++] = slot;
+        }
+    }
+    for(size_t i = 0; i < order.size(); i++) {
+        int slot = order[i];
+        order.insert(end(order), begin(children) + child_start[slot], begin(children) + child_start[slot + 1]);
+    }
+    
+    vector<int> new_slot(count);
+    for(int i = 0; i < count; i++) {
+        new_slot[order[i]] = i;
+    }
+    
+    vector<int> new_parents(count);
+    vector<int> new_depths(count);
+    vector<Transform> new_locals(count);
+    vector<mat4> new_worlds(count);
+    vector<unsigned char> new_dirty(count);
+    vector<SceneNode> new_ids(count);
+    
+    first_dirty = -1;
+    for(int i = 0; i < count; i++) {
+        int old = order[i];
+        int parent_slot = parents[old] == -1 ? -1 : new_slot[parents[old]];
+        new_parents[i] = parent_slot;
+        new_depths[i] = parent_slot == -1 ? 0 : new_depths[parent_slot] + 1;
+        new_locals[i] = locals[old];
+        new_worlds[i] = worlds[old];
+        new_dirty[i] = dirty[old];
+        new_ids[i] = ids[old];
+        slots[ids[old]] = i;
+        if(new_dirty[i] && first_dirty == -1) {
+            first_dirty = i;
+        }
+    }
+    
+    parents.swap(new_parents);
+    depths.swap(new_depths);
+    locals.swap(new_locals);
+    worlds.swap(new_worlds);
+    dirty.swap(new_dirty);
+    ids.swap(new_ids);
+    
+    needs_layout = false;
+}
+
+const vector<SceneNode>& SceneGraph::changed(void) const {
+    return changed_nodes;
+}
+
+/**
+ *  A parent is always worked out before its children,
+ *  so a changed parent passes its dirty flag down and
+ *  children can read its new world matrix straight away.
+ */
+void SceneGraph::updateRange(int begin, int end) {
+    for(int slot = begin; slot < end; slot++) {
+        int parent_slot = parents[slot];
+        if(parent_slot != -1 && dirty[parent_slot]) {
+            dirty[slot] = 1;
+        }
+        if(!dirty[slot]) {
+            continue;
+        }
+        
+        const Transform &t = locals[slot];
+        mat4 local = compose_trs(t.position, t.rotation, t.scale);
+        worlds[slot] = parent_slot == -1 ? local : worlds[parent_slot] * local;
+    }
+}
+
+void SceneGraph::finishUpdate(void) {
+    const int count = (int)ids.size();
+    for(int slot = first_dirty; slot < count; slot++) {
+        if(dirty[slot]) {
+            changed_nodes.push_back(ids[slot]);
+        }
+    }
+    
+    memset(&dirty[first_dirty], 0, count - first_dirty);
+    first_dirty = -1;
+}
+
+void SceneGraph::update(void) {
+    changed_nodes.clear();
+    
+    if(needs_layout) {
+        layout();
+    }
+    
+    if(first_dirty == -1) {
+        return;
+    }
+    
+    updateRange(first_dirty, (int)ids.size());
+    finishUpdate();
+}
+
+/**
+ *  Nodes on the same level never depend on each other, so
+ *  each level is split between the workers, one level at a
+ *  time. The breadth first layout keeps every level in one
+ *  run of slots.
+ */
+void SceneGraph::update(JobSystem &jobs) {
+    changed_nodes.clear();
+    
+    if(needs_layout) {
+        layout();
+    }
+    
+    if(first_dirty == -1) {
+        return;
+    }
+    
+    const int count = (int)ids.size();
+    int begin = first_dirty;
+    
+    while(begin < count) {
+        int end = (int)(upper_bound(std::begin(depths) + begin, std::end(depths), depths[begin]) - std::begin(depths));
+        
+        jobs.parallelFor(end - begin, scene_graph_grain, [this, begin](size_t from, size_t to) {
+            updateRange(begin + (int)from, begin + (int)to);
+        });
+        
+        begin = end;
+    }
+    
+    finishUpdate();
+}
@@ -0,0 +1,125 @@
+//
+//  SceneGraph.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 22/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef SceneGraph_hpp
+#define SceneGraph_hpp
+
+#include <cstddef>
+#include <vector>
+#include "VecMat.hpp"
+#include "JobSystem.hpp"
+
+/**
+ *  Nodes are handed out as ids that stay the same for
+ *  as long as the node is in the graph, no matter where
+ *  it ends up being stored.
+ */
+typedef int SceneNode;
+
+const SceneNode no_scene_node = -1;
+
+/**
+ *  Position, rotation and scale relative to the parent.
+ */
+struct Transform {
+    vec3 position;
+    versor rotation;
+    vec3 scale;
+    
+    Transform();
+};
+
+/**
+ *  Hierarchy of transforms where each node is placed relative
+ *  to its parent. Nodes are stored breadth first in flat arrays,
+ *  so every parent comes before its children and update can work
+ *  out all the world matrices in one pass from front to back.
+ *
+ *  Only nodes that changed (and everything under them) have
+ *  their world matrices worked out again, and the pass starts
+ *  at the first changed node rather than at the beginning.
+ */
+class SceneGraph {
+
+private:
+    /**
+     *  All indexed by slot, which is where a node
+     *  is stored in breadth first order.
+     */
+    std::vector<int> parents;
+    std::vector<int> depths;
+    std::vector<Transform> locals;
+    std::vector<mat4> worlds;
+    std::vector<unsigned char> dirty;
+    std::vector<SceneNode> ids;
+    
+    /**
+     *  Indexed by node id.
+     */
+    std::vector<int> slots;
+    
+    std::vector<SceneNode> changed_nodes;
+    
+    bool needs_layout = false;
+    int first_dirty = -1;
+    
+    void markDirty(int slot);
+    void layout(void);
+    void updateRange(int begin, int end);
+    void finishUpdate(void);
+
+public:
+    SceneGraph();
+    
+    /**
+     *  Adds a node under parent, or as a root if no parent
+     *  is given. The new node has an identity transform.
+     */
+    SceneNode create(SceneNode parent = no_scene_node);
+    
+    /**
+     *  Moves a node (with everything under it) to a new parent.
+     *  Returns false and changes nothing if that would make
+     *  the node its own ancestor.
+     */
+    bool setParent(SceneNode node, SceneNode parent);
+    SceneNode parent(SceneNode node) const;
+    
+    void setLocal(SceneNode node, const Transform &transform);
+    void setPosition(SceneNode node, const vec3 &position);
+    void setRotation(SceneNode node, const versor &rotation);
+    void setScale(SceneNode node, const vec3 &scale);
+    const Transform& local(SceneNode node) const;
+    
+    /**
+     *  Brings the world matrices up to date. Call this once
+     *  a frame after moving things and before reading them.
+     */
+    void update(void);
+    
+    /**
+     *  Same as above, with each level of the tree
+     *  split between the workers of the job system.
+     */
+    void update(JobSystem &jobs);
+    
+    /**
+     *  Only up to date after update has been called.
+     */
+    const mat4& world(SceneNode node) const;
+    
+    /**
+     *  The nodes whose world matrices changed in the last
+     *  update, so anything copying them can skip the rest.
+     */
+    const std::vector<SceneNode>& changed(void) const;
+    
+    size_t size(void) const;
+};
+
+#endif /* SceneGraph_hpp */
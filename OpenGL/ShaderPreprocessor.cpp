@@ -0,0 +1,301 @@
+//
+//  ShaderPreprocessor.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 01/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "ShaderPreprocessor.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+#define include_directive "#include"
+#define version_directive "#version"
+
+ShaderPreprocessor::ShaderPreprocessor() {}
+
+ShaderPreprocessor& ShaderPreprocessor::getInstance() {
+    static ShaderPreprocessor instance;
+    return instance;
+}
+
+/**
+ *  The directive a line starts with, skipping any
+ *  space before the # and between it and the name.
+ */
+static bool starts_with_directive(const string &line, const string &directive, size_t &end) {
+    size_t i = line.find_first_not_of(" \t");
+    if(string::npos == i || '#' != line[i]) {
+        return false;
+    }
+    i = line.find_first_not_of(" \t", i + 1);
+    if(string::npos == i || 0 != line.compare(i, directive.size() - 1, directive, 1, string::npos)) {
+        return false;
+    }
+    end = i + directive.size() - 1;
+    return true;
+}
+
+static string directory_of(const string &path) {
+    size_t slash = path.find_last_of('/');
+    return string::npos == slash ? "" : path.substr(0, slash + 1);
+}
+
+/**
+ *  True if name shows up in source as a whole word.
+ */
+static bool mentions(const string &source, const string &name) {
+    auto word = [](char c) {
+        return isalnum((unsigned char)c) || '_' == c;
+    };
+    
+    for(size_t at = source.find(name); string::npos != at; at = source.find(name, at + 1)) {
+        bool before = at > 0 && word(source[at - 1]);
+        bool after = at + name.size() < source.size() && word(source[at + name.size()]);
+        if(!before && !after) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ *  What is left of line once comments are taken out, where
+ *  in_comment carries an open block comment between lines.
+ */
+static string without_comments(const string &line, bool &in_comment) {
+    string code;
+    for(size_t i = 0; i < line.size(); i++) {
+        if(in_comment) {
+            if('*' == line[i] && i + 1 < line.size() && '/' == line[i + 1]) {
+                in_comment = false;
+                i++;
+            }
+            continue;
+        }
+        if('/' == line[i] && i + 1 < line.size()) {
+            if('/' == line[i + 1]) {
+                break;
+            }
+            if('*' == line[i + 1]) {
+                in_comment = true;
+                i++;
+                code += ' ';
+                continue;
+            }
+        }
+        code += line[i];
+    }
+    return code;
+}
+
+static string define_name(const string &define) {
+    return define.substr(0, define.find_first_of(" \t"));
+}
+
+/**
+ *  #line directives point compile errors back at the right
+ *  line, numbering each file in the order it was pasted in.
+ */
+bool ShaderPreprocessor::expand(const string &path, set<string> &included, int &file_count, string &out) {
+    if(included.count(path)) {
+        return true;
+    }
+    
+    /**
+     *  Counted before it is opened, so a missing file is
+     *  still a dependency and creating it can be noticed.
+     */
+    included.insert(path);
+    ifstream file(path, ios::in);
+    if(!file.is_open()) {
+        cerr << "Shader not found: " << path << endl;
+        return false;
+    }
+    
+    const int file_number = file_count++;
+    const bool root = 0 == file_number;
+    int line_number = 0;
+    string line;
+    
+    while(getline(file, line)) {
+        line_number++;
+        size_t end;
+        
+        if(starts_with_directive(line, include_directive, end)) {
+            size_t open = line.find('"', end);
+            size_t close = string::npos == open ? string::npos : line.find('"', open + 1);
+            if(string::npos == close) {
+                cerr << "Bad include in " << path << " at line " << line_number << ": " << line << endl;
+                return false;
+            }
+            
+            string include_path = directory_of(path) + line.substr(open + 1, close - open - 1);
+            
+            out += "#line 1 " + to_string(file_count) + "\n";
+            if(!expand(include_path, included, file_count, out)) {
+                return false;
+            }
+            out += "#line " + to_string(line_number + 1) + " " + to_string(file_number) + "\n";
+            continue;
+        }
+        
+        /**
+         *  Only the file at the top gets to say which version
+         *  it is, as #version has to come before anything else.
+         */
+        if(!root && starts_with_directive(line, version_directive, end)) {
+            out += "\n";
+            continue;
+        }
+        
+        out += line + "\n";
+    }
+    
+    return true;
+}
+
+/**
+ *  Null if the file or one of its includes couldn't be read.
+ *  Failures aren't kept, so the next request tries again.
+ */
+const string* ShaderPreprocessor::expandedSource(const string &path) {
+    auto found = expanded.find(path);
+    if(found != expanded.end()) {
+        return &found->second;
+    }
+    
+    set<string> included;
+    int file_count = 0;
+    string source;
+    bool read = expand(path, included, file_count, source);
+    
+    included_files[path] = vector<string>(begin(included), end(included));
+    if(!read) {
+        return nullptr;
+    }
+    return &(expanded[path] = source);
+}
+
+string ShaderPreprocessor::_load(const string &path, const vector<string> &defines) {
+    requests++;
+    const string *expanded_source = expandedSource(path);
+    if(!expanded_source) {
+        return "";
+    }
+    const string &source = *expanded_source;
+    
+    /**
+     *  Leave out defines the source never mentions, and sort
+     *  the rest, so variants that can only come out the same
+     *  share one key.
+     */
+    vector<string> used;
+    for(const auto &define: defines) {
+        if(mentions(source, define_name(define))) {
+            used.push_back(define);
+        }
+    }
+    sort(begin(used), end(used));
+    used.erase(unique(begin(used), end(used)), end(used));
+    
+    string key = path;
+    for(const auto &define: used) {
+        key += "\n" + define;
+    }
+    
+    auto found = variants.find(key);
+    if(found != variants.end()) {
+        return found->second;
+    }
+    
+    if(used.empty()) {
+        return variants[key] = source;
+    }
+    
+    /**
+     *  The defines go after #version, then a #line puts
+     *  the line numbers back to where they were.
+     */
+    string block;
+    for(const auto &define: used) {
+        block += "#define " + define + "\n";
+    }
+    
+    size_t insert_at = 0;
+    int next_line = 1;
+    bool in_comment = false;
+    for(size_t start = 0, number = 1; start < source.size(); number++) {
+        size_t stop = source.find('\n', start);
+        if(string::npos == stop) {
+            stop = source.size();
+        }
+        
+        /**
+         *  Comments and blank lines can come before #version,
+         *  so look past them, but nothing else can.
+         */
+        string line = without_comments(source.substr(start, stop - start), in_comment);
+        size_t end;
+        if(starts_with_directive(line, version_directive, end)) {
+            insert_at = min(stop + 1, source.size());
+            next_line = (int)number + 1;
+            break;
+        }
+        if(string::npos != line.find_first_not_of(" \t\r")) {
+            break;
+        }
+        start = stop + 1;
+    }
+    
+    block += "#line " + to_string(next_line) + " 0\n";
+    
+    string variant = source;
+    variant.insert(insert_at, block);
+    return variants[key] = variant;
+}
+
+vector<string> ShaderPreprocessor::_permutations(const string &path, const vector<string> &features) {
+    const size_t count = (size_t)1 << features.size();
+    vector<string> sources(count);
+    
+    for(size_t mask = 0; mask < count; mask++) {
+        vector<string> defines;
+        for(size_t i = 0; i < features.size(); i++) {
+            if(mask & ((size_t)1 << i)) {
+                defines.push_back(features[i]);
+            }
+        }
+        sources[mask] = _load(path, defines);
+    }
+    
+    return sources;
+}
+
+vector<string> ShaderPreprocessor::_dependencies(const string &path) {
+    expandedSource(path);
+    return included_files[path];
+}
+
+size_t ShaderPreprocessor::_variantCount(void) const {
+    return variants.size();
+}
+
+void ShaderPreprocessor::_clear(void) {
+    expanded.clear();
+    included_files.clear();
+    variants.clear();
+    requests = 0;
+}
+
+string ShaderPreprocessor::_repr(void) {
+    stringstream ss;
+    ss << "Shader variants: " << variants.size() << " made for " << requests << " requests";
+    return ss.str();
+}
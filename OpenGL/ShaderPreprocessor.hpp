@@ -0,0 +1,107 @@
+//
+//  ShaderPreprocessor.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 01/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef ShaderPreprocessor_hpp
+#define ShaderPreprocessor_hpp
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ *  Loads shader source the way ShaderLoader does, but also:
+ *
+ *  -   Pastes in any #include "file" it finds, relative to the
+ *      file doing the including. Each file goes in once, so
+ *      includes can't loop.
+ *  -   Adds #define lines just after #version, so one file can
+ *      be built for different sets of features instead of
+ *      branching on uniforms at runtime.
+ *
+ *  Every variant is kept, keyed by the file and the defines it
+ *  actually mentions. Asking for a feature a file never looks
+ *  at gives back the same source, so it links to the same
+ *  program rather than another copy of it.
+ */
+class ShaderPreprocessor {
+
+private:
+    ShaderPreprocessor();
+    ~ShaderPreprocessor() {};
+    ShaderPreprocessor(ShaderPreprocessor const &);
+    void operator=(ShaderPreprocessor const &);
+    static ShaderPreprocessor& getInstance();
+    
+    /**
+     *  Each file with its includes pasted in,
+     *  before any defines are added.
+     */
+    std::map<std::string, std::string> expanded;
+    std::map<std::string, std::vector<std::string>> included_files;
+    std::map<std::string, std::string> variants;
+    int requests = 0;
+    
+    bool expand(const std::string &path, std::set<std::string> &included, int &file_count, std::string &out);
+    const std::string* expandedSource(const std::string &path);
+    
+    std::string _load(const std::string &path, const std::vector<std::string> &defines);
+    std::vector<std::string> _permutations(const std::string &path, const std::vector<std::string> &features);
+    std::vector<std::string> _dependencies(const std::string &path);
+    size_t _variantCount(void) const;
+    void _clear(void);
+    std::string _repr(void);
+
+public:
+    
+    /**
+     *  The source of path with its includes resolved and each
+     *  of defines ("NAME" or "NAME value") added.
+     */
+    static std::string load(const std::string &path, const std::vector<std::string> &defines = std::vector<std::string>()) {
+        return getInstance()._load(path, defines);
+    }
+    
+    /**
+     *  One variant for each combination of features, where
+     *  bit i of the index says whether features[i] is defined.
+     */
+    static std::vector<std::string> permutations(const std::string &path, const std::vector<std::string> &features) {
+        return getInstance()._permutations(path, features);
+    }
+    
+    /**
+     *  Every file that goes in to path, itself included,
+     *  for knowing what to watch for changes. Files that
+     *  couldn't be read are listed too, so they can be
+     *  watched for turning up.
+     */
+    static std::vector<std::string> dependencies(const std::string &path) {
+        return getInstance()._dependencies(path);
+    }
+    
+    /**
+     *  How many different sources have been made so far.
+     */
+    static size_t variantCount(void) {
+        return getInstance()._variantCount();
+    }
+    
+    /**
+     *  Forgets everything, so edited files are read again.
+     */
+    static void clear(void) {
+        getInstance()._clear();
+    }
+    
+    static std::string repr(void) {
+        return getInstance()._repr();
+    }
+};
+
+#endif /* ShaderPreprocessor_hpp */
@@ -7,7 +7,7 @@
 //
 
 #include <iostream>
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <stdio.h>
@@ -7,7 +7,7 @@
 //
 
 #include "Shapes.hpp"
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <vector>
@@ -15,6 +15,7 @@
 #include "ShaderLoader.hpp"
 #include "Logger.hpp"
 #include "GLParams.hpp"
+#include "GLState.hpp"
 
 using namespace std;
 
@@ -40,7 +41,7 @@ GLuint setupLineStrip(const float *points) {
      */
     GLuint vbo;
     glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, 15 * sizeof(float), points, GL_STATIC_DRAW);
     
     /**
@@ -48,8 +49,8 @@ GLuint setupLineStrip(const float *points) {
      */
     GLuint vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::bindVertexArray(vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
     
@@ -65,7 +66,7 @@ GLuint setupTriangle(const float *points) {
      */
     GLuint vbo;
     glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, 9 * sizeof(float), points, GL_STATIC_DRAW);
     
     /**
@@ -73,8 +74,8 @@ GLuint setupTriangle(const float *points) {
      */
     GLuint vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::bindVertexArray(vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
     
@@ -90,7 +91,7 @@ GLuint setupSquare(const float *points) {
      */
     GLuint vbo;
     glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, 18 * sizeof(float), points, GL_STATIC_DRAW);
     
     /**
@@ -98,8 +99,8 @@ GLuint setupSquare(const float *points) {
      */
     GLuint vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLState::bindVertexArray(vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
     
@@ -113,13 +114,13 @@ void drawItem(const GLuint vao, const int gl_which, const int items, const GLuin
     /**
      *  Use the shader program, bind the vertex array and then draw.
      */
-    glUseProgram(shader_program);
-    glBindVertexArray(vao);
+    GLState::useProgram(shader_program);
+    GLState::bindVertexArray(vao);
     glDrawArrays(gl_which, 0, items);
     /**
      *  Then clear the vertex array.
      */
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 /**
@@ -175,6 +176,7 @@ int shapes_main(void) {
         return -1;
     }
     glfwMakeContextCurrent(window);
+    GLState::invalidate();
     
     /**
      *  Get the version info.
@@ -195,8 +197,8 @@ int shapes_main(void) {
     /**
      *  Instruct GL to draw a pixel if it is closer to the viewer.
      */
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_LESS);
     
     
     /**
@@ -349,12 +351,12 @@ int shapes_main(void) {
         /**
          *  Setting the GL Viewport
          */
-        glViewport(0, 0, w_width, w_height);
+        GLState::viewport(0, 0, w_width, w_height);
         
         /**
          *  Set the background colour
          */
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        GLState::clearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
         /**
          *  Draw the line strip, triangles and then a full square.
@@ -0,0 +1,188 @@
+//
+//  StaticBatch.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 27/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "StaticBatch.hpp"
+#include <algorithm>
+#include <cstring>
+#include "GLState.hpp"
+#include "MeshBuffers.hpp"
+#include "Logger.hpp"
+#include "TraceLog.hpp"
+
+using namespace std;
+
+#define world_matrices_uniform "world_matrices"
+#define world_base_uniform "world_base"
+
+/**
+ *  Texels in one world matrix, one per column.
+ */
+#define texels_per_matrix 4
+
+StaticBatch::StaticBatch() {}
+
+StaticBatch::~StaticBatch() {
+    release();
+}
+
+void StaticBatch::release(void) {
+    for(RangeHandle range: slot_ranges) {
+        MeshBuffers::free(range);
+    }
+    slot_ranges.clear();
+    
+    if(indirect_buffer) {
+        GLState::forgetBuffer(indirect_buffer);
+        glDeleteBuffers(1, &indirect_buffer);
+    }
+    
+    if(world_texture) {
+        glDeleteTextures(1, &world_texture);
+    }
+    world_stream.reset();
+    frame_open = false;
+    worlds_ready = false;
+    
+    world_texture = indirect_buffer = 0;
+    world_base = 0;
+}
+
+size_t StaticBatch::size(void) const {
+    return slot_ranges.size();
+}
+
+bool StaticBatch::indirect(void) const {
+    return use_indirect;
+}
+
+void StaticBatch::build(const vector<Mesh> &meshes, const vector<int> &slot_meshes) {
+    release();
+    
+    for(size_t slot = 0; slot < slot_meshes.size(); slot++) {
+        const Mesh &mesh = meshes[slot_meshes[slot]];
+        slot_ranges.push_back(MeshBuffers::allocate(mesh.pointsUnwound(), mesh.coloursUnwound(), (GLuint)slot));
+    }
+    
+    /**
+     *  The texture covers every frame's copy of the matrices,
+     *  which works without glTexBufferRange (GL 4.3) and lets
+     *  the shader pick the right copy with an offset.
+     */
+    if(!slot_meshes.empty()) {
+        world_stream.reset(new StreamBuffer(GL_TEXTURE_BUFFER, slot_meshes.size() * sizeof(mat4)));
+        
+        glGenTextures(1, &world_texture);
+        glBindTexture(GL_TEXTURE_BUFFER, world_texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, world_stream->getBuffer());
+    }
+    
+    /**
+     *  Indirect draws need GL 4.3, which we may have been
+     *  built against but still not be given at runtime.
+     */
+    use_indirect = false;
+#if defined(GL_VERSION_4_3)
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    use_indirect = major > 4 || (major == 4 && minor >= 3);
+    
+    if(use_indirect) {
+        glGenBuffers(1, &indirect_buffer);
+    }
+#endif
+}
+
+void StaticBatch::updateWorlds(const vector<mat4> &worlds) {
+    if(!world_stream || worlds.empty()) {
+        return;
+    }
+    
+    world_stream->beginFrame();
+    frame_open = true;
+    worlds_ready = false;
+    
+    const size_t bytes = min(worlds.size(), slot_ranges.size()) * sizeof(mat4);
+    GLintptr offset = 0;
+    void *dest = world_stream->allocate(bytes, sizeof(mat4), offset);
+    if(!dest) {
+        LOG_ERROR("StaticBatch: no room for %zu world matrices, skipping this frame's draws.", bytes / sizeof(mat4));
+        return;
+    }
+    
+    memcpy(dest, &worlds[0], bytes);
+    world_stream->flush();
+    world_base = (GLint)(offset / sizeof(mat4)) * texels_per_matrix;
+    worlds_ready = true;
+    TRACE("world matrices: %zu at offset %ld", bytes / sizeof(mat4), (long)offset);
+}
+
+/**
+ *  Without this frame's matrices world_base would point at
+ *  an older copy the GPU may still be reading, or that is
+ *  being written again, so nothing is drawn.
+ */
+void StaticBatch::draw(GLuint program, GLenum mode, const vector<int> &slots) {
+    if(slot_ranges.empty() || slots.empty() || !worlds_ready) {
+        return;
+    }
+    
+    GLState::useProgram(program);
+    GLState::bindVertexArray(MeshBuffers::getVao());
+    
+    if(sampler_program != program) {
+        sampler_program = program;
+        sampler_location = glGetUniformLocation(program, world_matrices_uniform);
+        base_location = glGetUniformLocation(program, world_base_uniform);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, world_texture);
+    if(-1 != sampler_location) {
+        glUniform1i(sampler_location, 0);
+    }
+    if(-1 != base_location) {
+        glUniform1i(base_location, world_base);
+    }
+    
+#if defined(GL_VERSION_4_3)
+    if(use_indirect) {
+        draw_commands.resize(slots.size());
+        for(size_t i = 0; i < slots.size(); i++) {
+            DrawArraysIndirectCommand &command = draw_commands[i];
+            command.count = (GLuint)MeshBuffers::count(slot_ranges[slots[i]]);
+            command.instance_count = 1;
+            command.first = (GLuint)MeshBuffers::first(slot_ranges[slots[i]]);
+            command.base_instance = 0;
+        }
+        
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, draw_commands.size() * sizeof(DrawArraysIndirectCommand), &draw_commands[0], GL_STREAM_DRAW);
+        glMultiDrawArraysIndirect(mode, NULL, (GLsizei)draw_commands.size(), 0);
+        TRACE("draw: %zu slots, indirect", slots.size());
+        return;
+    }
+#endif
+    
+    draw_firsts.resize(slots.size());
+    draw_counts.resize(slots.size());
+    for(size_t i = 0; i < slots.size(); i++) {
+        draw_firsts[i] = MeshBuffers::first(slot_ranges[slots[i]]);
+        draw_counts[i] = MeshBuffers::count(slot_ranges[slots[i]]);
+    }
+    glMultiDrawArrays(mode, &draw_firsts[0], &draw_counts[0], (GLsizei)slots.size());
+    TRACE("draw: %zu slots", slots.size());
+}
+
+void StaticBatch::endFrame(void) {
+    worlds_ready = false;
+    if(frame_open) {
+        world_stream->endFrame();
+        frame_open = false;
+    }
+}
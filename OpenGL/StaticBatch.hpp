@@ -0,0 +1,130 @@
+//
+//  StaticBatch.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 27/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef StaticBatch_hpp
+#define StaticBatch_hpp
+
+#include "GLPlatform.h"
+#include <vector>
+#include <memory>
+#include "VecMat.hpp"
+#include "Mesh.hpp"
+#include "StreamBuffer.hpp"
+
+/**
+ *  Layout of one draw in the indirect buffer,
+ *  as glMultiDrawArraysIndirect expects it.
+ */
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first;
+    GLuint base_instance;
+};
+
+/**
+ *  Puts the geometry of a set of meshes that never change
+ *  shape in to the shared MeshBuffers arena, so any subset of
+ *  them can be drawn with a single call through its one VAO.
+ *
+ *  Each vertex carries the slot it was packed in to (attribute
+ *  2, "draw_slot"), and the world matrices of all the slots sit
+ *  in a texture buffer ("world_matrices"), so the vertex shader
+ *  can find its own matrix whichever way the draws are issued.
+ *  The matrices are written every frame in to a stream buffer,
+ *  and "world_base" says where this frame's copy starts.
+ *
+ *  On GL 4.3 and up the draws go through one
+ *  glMultiDrawArraysIndirect call, otherwise (like on the 4.1
+ *  core profile macOS gives us) through one glMultiDrawArrays.
+ */
+class StaticBatch {
+
+private:
+    std::unique_ptr<StreamBuffer> world_stream;
+    GLuint world_texture = 0;
+    GLint world_base = 0;
+    GLuint indirect_buffer = 0;
+    
+    /**
+     *  Whether this frame's matrices have been
+     *  written and are waiting for endFrame.
+     */
+    bool frame_open = false;
+    
+    /**
+     *  Whether world_base points at matrices written
+     *  this frame. draw does nothing until it does.
+     */
+    bool worlds_ready = false;
+    
+    bool use_indirect = false;
+    
+    /**
+     *  Each slot's range in the arena. Looked up when drawing,
+     *  as defragmenting the arena can move them.
+     */
+    std::vector<RangeHandle> slot_ranges;
+    
+    /**
+     *  Rebuilt every frame from the visible slots.
+     */
+    std::vector<GLint> draw_firsts;
+    std::vector<GLsizei> draw_counts;
+    std::vector<DrawArraysIndirectCommand> draw_commands;
+    
+    GLuint sampler_program = 0;
+    GLint sampler_location = -1;
+    GLint base_location = -1;
+    
+    StaticBatch(const StaticBatch &);
+    void operator=(const StaticBatch &);
+
+public:
+    StaticBatch();
+    ~StaticBatch();
+    
+    /**
+     *  Gives the slots' ranges back to the arena and deletes
+     *  the rest, for when the context is going away.
+     */
+    void release(void);
+    
+    /**
+     *  Packs meshes[slot_meshes[slot]] for each slot.
+     *  The same mesh can be used by more than one slot.
+     */
+    void build(const std::vector<Mesh> &meshes, const std::vector<int> &slot_meshes);
+    
+    /**
+     *  Writes one world matrix per slot for this frame.
+     *  Call once a frame before draw, even if nothing
+     *  moved, as each frame gets its own copy. If there
+     *  is no room for them the frame's draws are skipped.
+     */
+    void updateWorlds(const std::vector<mat4> &worlds);
+    
+    /**
+     *  Draws the given slots with one call, using texture
+     *  unit 0 for the world matrices. Can be called once
+     *  for each view that draws the batch.
+     */
+    void draw(GLuint program, GLenum mode, const std::vector<int> &slots);
+    
+    /**
+     *  Fences this frame's matrices, so the region is not
+     *  written again until the GPU has finished with it. Call
+     *  once a frame, after every view has been drawn.
+     */
+    void endFrame(void);
+    
+    size_t size(void) const;
+    bool indirect(void) const;
+};
+
+#endif /* StaticBatch_hpp */
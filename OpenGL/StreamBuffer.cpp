@@ -0,0 +1,152 @@
+//
+//  StreamBuffer.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 29/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "StreamBuffer.hpp"
+#include <cstring>
+#include "GLState.hpp"
+
+using namespace std;
+
+/**
+ *  How long to wait on a fence each time
+ *  round, in nanoseconds.
+ */
+#define stream_fence_timeout 1000000
+
+StreamBuffer::StreamBuffer(GLenum _target, size_t _frame_size, int _frames) : target(_target), frame_size(_frame_size), frames(_frames) {
+    
+    fences.resize(frames, (GLsync)0);
+    const size_t total = frame_size * frames;
+    
+    glGenBuffers(1, &buffer);
+    GLState::bindBuffer(target, buffer);
+    
+#if defined(GL_VERSION_4_4)
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    
+    if(major > 4 || (major == 4 && minor >= 4)) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, total, NULL, flags);
+        mapped = (unsigned char *)glMapBufferRange(target, 0, total, flags);
+        persistent = mapped != nullptr;
+    }
+#endif
+    
+    if(!persistent) {
+        glBufferData(target, total, NULL, GL_STREAM_DRAW);
+        staging.resize(frame_size);
+    }
+}
+
+StreamBuffer::~StreamBuffer() {
+    for(auto &fence: fences) {
+        if(fence) {
+            glDeleteSync(fence);
+        }
+    }
+    
+    if(buffer) {
+        if(persistent) {
+            GLState::bindBuffer(target, buffer);
+            glUnmapBuffer(target);
+        }
+        GLState::forgetBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+GLuint StreamBuffer::getBuffer(void) const {
+    return buffer;
+}
+
+size_t StreamBuffer::size(void) const {
+    return frame_size * frames;
+}
+
+bool StreamBuffer::isPersistent(void) const {
+    return persistent;
+}
+
+size_t StreamBuffer::frameStart(void) const {
+    return frame_size * frame;
+}
+
+void StreamBuffer::beginFrame(void) {
+    frame = (frame + 1) % frames;
+    head = 0;
+    flushed = 0;
+    
+    GLsync &fence = fences[frame];
+    if(!fence) {
+        return;
+    }
+    
+    for(;;) {
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, stream_fence_timeout);
+        if(GL_ALREADY_SIGNALED == result || GL_CONDITION_SATISFIED == result || GL_WAIT_FAILED == result) {
+            break;
+        }
+    }
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+void* StreamBuffer::allocate(size_t bytes, size_t alignment, GLintptr &offset) {
+    if(frame < 0) {
+        return nullptr;
+    }
+    
+    /**
+     *  Align the offset in the whole buffer, as that
+     *  is what gets handed to GL.
+     */
+    size_t start = frameStart() + head;
+    if(alignment > 1) {
+        start = (start + alignment - 1) / alignment * alignment;
+    }
+    size_t local = start - frameStart();
+    
+    if(local + bytes > frame_size) {
+        return nullptr;
+    }
+    
+    head = local + bytes;
+    offset = (GLintptr)start;
+    return persistent ? mapped + start : &staging[local];
+}
+
+void StreamBuffer::flush(void) {
+    if(persistent || head <= flushed) {
+        flushed = head;
+        return;
+    }
+    
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    GLState::bindBuffer(target, buffer);
+    void *dest = glMapBufferRange(target, frameStart() + flushed, head - flushed, flags);
+    if(dest) {
+        memcpy(dest, &staging[flushed], head - flushed);
+        glUnmapBuffer(target);
+    }
+    flushed = head;
+}
+
+void StreamBuffer::endFrame(void) {
+    if(frame < 0) {
+        return;
+    }
+    
+    GLsync &fence = fences[frame];
+    if(fence) {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
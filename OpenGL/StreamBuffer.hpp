@@ -0,0 +1,92 @@
+//
+//  StreamBuffer.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 29/03/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef StreamBuffer_hpp
+#define StreamBuffer_hpp
+
+#include "GLPlatform.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ *  How many frames of data can be in flight
+ *  at once before we have to wait for the GPU.
+ */
+const int stream_buffer_frames = 3;
+
+/**
+ *  A ring buffer for data that is written fresh every frame,
+ *  like world matrices, instance data or uniform blocks. The
+ *  buffer is split in to one region per frame in flight. Each
+ *  frame writes to the next region along, and a fence makes
+ *  sure the GPU has finished reading a region before we write
+ *  to it again, so the driver never has to stall or copy.
+ *
+ *  On GL 4.4 and up the buffer is mapped once, persistently,
+ *  and written to directly. Otherwise writes go to memory on
+ *  our side and are copied in by flush, through an unsynchronised
+ *  map (which is safe, as the fence has already been waited on).
+ *
+ *  Needs a current context to be made.
+ */
+class StreamBuffer {
+
+private:
+    GLenum target;
+    size_t frame_size;
+    int frames;
+    GLuint buffer = 0;
+    
+    bool persistent = false;
+    unsigned char *mapped = nullptr;
+    std::vector<unsigned char> staging;
+    
+    std::vector<GLsync> fences;
+    int frame = -1;
+    size_t head = 0;
+    size_t flushed = 0;
+    
+    StreamBuffer(const StreamBuffer &);
+    void operator=(const StreamBuffer &);
+    
+    size_t frameStart(void) const;
+
+public:
+    StreamBuffer(GLenum target, size_t frame_size, int frames = stream_buffer_frames);
+    ~StreamBuffer();
+    
+    /**
+     *  Moves on to the next region, waiting for
+     *  the GPU to be done with it if it has to.
+     */
+    void beginFrame(void);
+    
+    /**
+     *  Space for bytes in this frame's region, at an offset in the
+     *  whole buffer that is a multiple of alignment. Returns null
+     *  when the region is full.
+     */
+    void* allocate(size_t bytes, size_t alignment, GLintptr &offset);
+    
+    /**
+     *  Makes everything allocated so far visible to GL.
+     *  Call before drawing with it.
+     */
+    void flush(void);
+    
+    /**
+     *  Fences the region once the draws using it have been issued.
+     */
+    void endFrame(void);
+    
+    GLuint getBuffer(void) const;
+    size_t size(void) const;
+    bool isPersistent(void) const;
+};
+
+#endif /* StreamBuffer_hpp */
@@ -9,7 +9,7 @@
 #ifndef Structs_h
 #define Structs_h
 
-#include <GLFW/glfw3.h>
+#include "GLPlatform.h"
 
 struct Point {
     GLfloat x;
@@ -0,0 +1,29 @@
+//
+//  TraceDecode.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 07/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <iostream>
+#include "TraceLog.hpp"
+
+using namespace std;
+
+/**
+ *  Prints a trace file written by TraceLog as text.
+ */
+int main(int argc, const char * argv[]) {
+    if(argc < 2) {
+        cerr << "Usage: TraceDecode <trace file>" << endl;
+        return 1;
+    }
+    
+    if(!TraceLog::decode(argv[1], cout)) {
+        cerr << "Could not read the trace file: " << argv[1] << endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,357 @@
+//
+//  TraceLog.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 07/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "TraceLog.hpp"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+
+using namespace std;
+
+/**
+ *  Bump this if TraceRecord or the file layout changes.
+ */
+#define trace_file_magic 0x43525454
+#define trace_file_version 1
+
+/**
+ *  The writer wakes this often. Traces aren't urgent, and the
+ *  rings are big enough to hold a good few frames between.
+ */
+#define trace_flush_interval_ms 50
+
+/**
+ *  A record with this format brings in a format string: args[0]
+ *  is its id and args[1] its length, and the string follows,
+ *  padded out to a whole number of records.
+ */
+#define trace_format_definition 0xffffffffu
+
+struct TraceFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+};
+
+TraceLog::TraceLog() : enabled(false), dropped(0) {}
+
+TraceLog::~TraceLog() {
+    _stop();
+}
+
+TraceLog& TraceLog::getInstance() {
+    static TraceLog instance;
+    return instance;
+}
+
+uint64_t TraceLog::now(void) const {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ *  Each thread gets its own ring the first time it traces,
+ *  so it is the only one ever pushing to it.
+ */
+TraceLog::ThreadRing& TraceLog::ring(uint16_t &index) {
+    thread_local ThreadRing *local_ring = nullptr;
+    thread_local uint16_t local_index = 0;
+    
+    if(!local_ring) {
+        lock_guard<mutex> guard(rings_lock);
+        rings.push_back(unique_ptr<ThreadRing>(new ThreadRing(trace_ring_size)));
+        local_ring = rings.back().get();
+        local_index = (uint16_t)(rings.size() - 1);
+    }
+    
+    index = local_index;
+    return *local_ring;
+}
+
+bool TraceLog::_start(const string &path) {
+    _stop();
+    
+    {
+        lock_guard<mutex> guard(write_lock);
+        file = fopen(path.c_str(), "wb");
+        if(!file) {
+            cerr << "Could not open the trace file: " << path << endl;
+            return false;
+        }
+        
+        TraceFileHeader header = {trace_file_magic, trace_file_version, (uint32_t)sizeof(TraceRecord), 0};
+        fwrite(&header, sizeof(header), 1, file);
+        start_time = now();
+        
+        lock_guard<mutex> formats_guard(formats_lock);
+        formats_written = 0;
+    }
+    
+    stopping = false;
+    enabled.store(true, memory_order_relaxed);
+    
+#if !defined(OPENGL_SINGLE_THREADED)
+    thread = std::thread(&TraceLog::worker, this);
+#endif
+    return true;
+}
+
+void TraceLog::_stop(void) {
+    enabled.store(false, memory_order_relaxed);
+    
+    {
+        lock_guard<mutex> guard(wake_lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    
+    if(thread.joinable()) {
+        thread.join();
+    }
+    
+    writeBatch();
+    
+    lock_guard<mutex> guard(write_lock);
+    if(file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+/**
+ *  Formats are never forgotten, so one that was used
+ *  before start still has its id afterwards.
+ */
+uint32_t TraceLog::_format(const char *format) {
+    lock_guard<mutex> guard(formats_lock);
+    formats.push_back(format);
+    return (uint32_t)(formats.size() - 1);
+}
+
+void TraceLog::_write(uint32_t format, uint8_t count, uint8_t float_mask, const uint64_t *args) {
+    TraceRecord record;
+    ThreadRing &thread_ring = ring(record.thread);
+    
+    record.time = now();
+    record.format = format;
+    record.count = count;
+    record.float_mask = float_mask;
+    memcpy(record.args, args, count * sizeof(uint64_t));
+    
+#if defined(OPENGL_SINGLE_THREADED)
+    /**
+     *  Nothing empties the ring in the background here,
+     *  so the thread that filled it writes it out.
+     */
+    if(!thread_ring.push(record)) {
+        writeBatch();
+        thread_ring.push(record);
+    }
+#else
+    if(!thread_ring.push(record)) {
+        dropped.fetch_add(1, memory_order_relaxed);
+    }
+#endif
+}
+
+void TraceLog::worker(void) {
+    unique_lock<mutex> lock(wake_lock);
+    
+    while(!stopping) {
+        wake.wait_for(lock, chrono::milliseconds(trace_flush_interval_ms));
+        
+        lock.unlock();
+        writeBatch();
+        lock.lock();
+    }
+}
+
+/**
+ *  Any format a trace in the batch uses was made before the
+ *  trace was, so taking the traces first and then writing new
+ *  formats ahead of them means the decoder always has them.
+ */
+void TraceLog::writeBatch(void) {
+    lock_guard<mutex> guard(write_lock);
+    if(!file) {
+        return;
+    }
+    
+    batch.clear();
+    {
+        lock_guard<mutex> rings_guard(rings_lock);
+        for(auto &thread_ring: rings) {
+            size_t waiting = thread_ring->size();
+            if(0 == waiting) {
+                continue;
+            }
+            
+            size_t first = batch.size();
+            batch.resize(first + waiting);
+            thread_ring->pop(&batch[first], waiting);
+        }
+    }
+    
+    writeFormats();
+    
+    for(auto &record: batch) {
+        record.time -= start_time;
+    }
+    if(!batch.empty()) {
+        fwrite(&batch[0], sizeof(TraceRecord), batch.size(), file);
+    }
+    fflush(file);
+}
+
+void TraceLog::writeFormats(void) {
+    lock_guard<mutex> guard(formats_lock);
+    
+    for(; formats_written < formats.size(); formats_written++) {
+        const string &format = formats[formats_written];
+        
+        TraceRecord definition = {};
+        definition.format = trace_format_definition;
+        definition.args[0] = formats_written;
+        definition.args[1] = format.size();
+        fwrite(&definition, sizeof(definition), 1, file);
+        
+        vector<char> padded((format.size() + sizeof(TraceRecord) - 1) / sizeof(TraceRecord) * sizeof(TraceRecord), 0);
+        memcpy(padded.data(), format.data(), format.size());
+        fwrite(padded.data(), 1, padded.size(), file);
+    }
+}
+
+/**
+ *  Formats one record by walking its format string and handing
+ *  each conversion to snprintf on its own, with its argument
+ *  read back as the type it was stored as. Length modifiers are
+ *  swapped for ll, since every integer was stored as 64 bits.
+ */
+static string trace_text(const string &format, const TraceRecord &record) {
+    string text;
+    char buffer[128];
+    int arg = 0;
+    
+    for(size_t i = 0; i < format.size(); i++) {
+        if('%' != format[i]) {
+            text += format[i];
+            continue;
+        }
+        if(i + 1 < format.size() && '%' == format[i + 1]) {
+            text += '%';
+            i++;
+            continue;
+        }
+        
+        string spec = "%";
+        size_t j = i + 1;
+        while(j < format.size() && strchr("-+ #0123456789.", format[j])) {
+            spec += format[j++];
+        }
+        while(j < format.size() && strchr("hlLqjzt", format[j])) {
+            j++;
+        }
+        if(j >= format.size()) {
+            break;
+        }
+        
+        char conversion = format[j];
+        i = j;
+        
+        if(arg >= record.count) {
+            text += "<missing>";
+            continue;
+        }
+        
+        const uint64_t value = record.args[arg];
+        const bool is_float = record.float_mask & (1 << arg);
+        arg++;
+        
+        if(strchr("fFeEgGaA", conversion)) {
+            double d = 0.0;
+            if(is_float) {
+                memcpy(&d, &value, sizeof(d));
+            }
+            else {
+                d = (double)(int64_t)value;
+            }
+            snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(), d);
+        }
+        else if(strchr("diouxXc", conversion)) {
+            long long n = (long long)value;
+            if(is_float) {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                n = (long long)d;
+            }
+            if('c' == conversion) {
+                snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(), (int)n);
+            }
+            else {
+                snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), n);
+            }
+        }
+        else if('p' == conversion) {
+            snprintf(buffer, sizeof(buffer), "%p", (void *)(uintptr_t)value);
+        }
+        else {
+            snprintf(buffer, sizeof(buffer), "<%%%c>", conversion);
+        }
+        text += buffer;
+    }
+    
+    return text;
+}
+
+bool TraceLog::decode(const string &path, ostream &out) {
+    ifstream file(path, ios::in | ios::binary);
+    if(!file.is_open()) {
+        return false;
+    }
+    
+    TraceFileHeader header;
+    if(!file.read((char *)&header, sizeof(header)) ||
+       trace_file_magic != header.magic ||
+       trace_file_version != header.version ||
+       sizeof(TraceRecord) != header.record_size) {
+        return false;
+    }
+    
+    vector<string> formats;
+    TraceRecord record;
+    
+    while(file.read((char *)&record, sizeof(record))) {
+        if(trace_format_definition == record.format) {
+            size_t id = (size_t)record.args[0];
+            size_t length = (size_t)record.args[1];
+            size_t padded = (length + sizeof(TraceRecord) - 1) / sizeof(TraceRecord) * sizeof(TraceRecord);
+            
+            vector<char> text(padded);
+            if(padded && !file.read(text.data(), padded)) {
+                return false;
+            }
+            if(formats.size() <= id) {
+                formats.resize(id + 1);
+            }
+            formats[id].assign(text.data(), length);
+            continue;
+        }
+        
+        out << "[" << fixed << setprecision(6) << setw(12) << record.time / 1e9 << "] ";
+        out << "[" << record.thread << "] ";
+        if(record.format < formats.size()) {
+            out << trace_text(formats[record.format], record) << "\n";
+        }
+        else {
+            out << "unknown format " << record.format << "\n";
+        }
+    }
+    
+    return true;
+}
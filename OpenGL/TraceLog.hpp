@@ -0,0 +1,215 @@
+//
+//  TraceLog.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 07/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef TraceLog_hpp
+#define TraceLog_hpp
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <ostream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "RingBuffer.hpp"
+
+/**
+ *  The most arguments one trace can carry.
+ */
+#define trace_max_args 6
+
+/**
+ *  Traces each thread can have waiting to be written.
+ */
+#define trace_ring_size 8192
+
+/**
+ *  One trace as it is stored, 64 bytes. The format is an id from
+ *  TraceLog::format, and float_mask has a bit set for each
+ *  argument that is a double rather than an integer.
+ */
+struct TraceRecord {
+    uint64_t time;
+    uint32_t format;
+    uint16_t thread;
+    uint8_t count;
+    uint8_t float_mask;
+    uint64_t args[trace_max_args];
+};
+
+/**
+ *  Very cheap logging for things that happen every frame, like
+ *  draws and matrix uploads. A trace is a format id and its raw
+ *  arguments copied in to a ring for the thread that made it, with
+ *  no formatting at all. A background thread writes the rings to a
+ *  binary file, which TraceDecode turns back in to text.
+ *
+ *  Arguments must be numbers or pointers, since only their bits
+ *  are kept. Strings should go through Logger instead.
+ *
+ *  Until start is called, a trace only checks a flag.
+ */
+class TraceLog {
+
+private:
+    TraceLog();
+    ~TraceLog();
+    TraceLog(TraceLog const &);
+    void operator=(TraceLog const &);
+    static TraceLog& getInstance();
+    
+    typedef RingBuffer<TraceRecord> ThreadRing;
+    
+    std::atomic<bool> enabled;
+    std::atomic<size_t> dropped;
+    
+    /**
+     *  Rings are never freed before the log, so the
+     *  writer can keep reading one after its thread ends.
+     */
+    std::mutex rings_lock;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    
+    std::mutex formats_lock;
+    std::vector<std::string> formats;
+    size_t formats_written = 0;
+    
+    std::mutex write_lock;
+    FILE *file = nullptr;
+    uint64_t start_time = 0;
+    std::vector<TraceRecord> batch;
+    
+    std::thread thread;
+    std::mutex wake_lock;
+    std::condition_variable wake;
+    bool stopping = false;
+    
+    ThreadRing& ring(uint16_t &index);
+    uint64_t now(void) const;
+    void worker(void);
+    void writeBatch(void);
+    void writeFormats(void);
+    
+    bool _start(const std::string &path);
+    void _stop(void);
+    uint32_t _format(const char *format);
+    void _write(uint32_t format, uint8_t count, uint8_t float_mask, const uint64_t *args);
+    
+    /**
+     *  Each argument is kept as 64 bits, doubles
+     *  by their bits and everything else as an integer.
+     */
+    template<typename T>
+    static void pack(uint64_t *args, uint8_t &float_mask, int index, T value) {
+        static_assert(std::is_arithmetic<T>::value || std::is_pointer<T>::value || std::is_enum<T>::value,
+                      "Traces can only take numbers and pointers");
+        packValue(args[index], float_mask, index, value, std::is_floating_point<T>());
+    }
+    
+    template<typename T>
+    static void packValue(uint64_t &arg, uint8_t &float_mask, int index, T value, std::true_type) {
+        double d = (double)value;
+        memcpy(&arg, &d, sizeof(arg));
+        float_mask |= (uint8_t)(1 << index);
+    }
+    
+    template<typename T>
+    static void packValue(uint64_t &arg, uint8_t &, int, T value, std::false_type) {
+        arg = (uint64_t)(value);
+    }
+    
+    static void packAll(uint64_t *, uint8_t &, int) {}
+    
+    template<typename T, typename... Rest>
+    static void packAll(uint64_t *args, uint8_t &float_mask, int index, T value, Rest... rest) {
+        pack(args, float_mask, index, value);
+        packAll(args, float_mask, index + 1, rest...);
+    }
+
+public:
+    /**
+     *  Starts writing traces to path. Returns
+     *  false if the file can't be opened.
+     */
+    static bool start(const std::string &path) {
+        return getInstance()._start(path);
+    }
+    
+    /**
+     *  Writes out anything waiting and closes the file.
+     */
+    static void stop(void) {
+        getInstance()._stop();
+    }
+    
+    static bool isEnabled(void) {
+        return getInstance().enabled.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     *  Gives a format string its id. The TRACE macro calls
+     *  this once per call site, so the string is only
+     *  looked at the first time.
+     */
+    static uint32_t format(const char *format) {
+        return getInstance()._format(format);
+    }
+    
+    template<typename... Args>
+    static void write(uint32_t format, Args... args) {
+        static_assert(sizeof...(Args) <= trace_max_args, "Too many arguments for one trace");
+        
+        TraceLog &log = getInstance();
+        if(!log.enabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        
+        uint64_t packed[trace_max_args];
+        uint8_t float_mask = 0;
+        packAll(packed, float_mask, 0, args...);
+        log._write(format, (uint8_t)sizeof...(Args), float_mask, packed);
+    }
+    
+    /**
+     *  Writes out everything waiting now, rather
+     *  than when the background thread next wakes.
+     */
+    static void flush(void) {
+        getInstance().writeBatch();
+    }
+    
+    /**
+     *  Traces dropped because a thread's ring was full.
+     */
+    static size_t droppedCount(void) {
+        return getInstance().dropped.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     *  Turns a trace file back in to text, one line per
+     *  trace. Returns false if it isn't a trace file.
+     */
+    static bool decode(const std::string &path, std::ostream &out);
+};
+
+/**
+ *  TRACE("draw %u slots", count) - printf style, but the format
+ *  must be a string literal and the arguments numbers.
+ */
+#define TRACE(format_string, ...) \
+    do { \
+        static const uint32_t trace_format_id = TraceLog::format(format_string); \
+        TraceLog::write(trace_format_id, ##__VA_ARGS__); \
+    } while(0)
+
+#endif /* TraceLog_hpp */
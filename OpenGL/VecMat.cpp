@@ -361,7 +361,7 @@ versor normalise(versor &q) {
         q.q[0] * q.q[0] + q.q[1] * q.q[1] +
         q.q[2] * q.q[2] + q.q[3] * q.q[3];
     const float thresh = 0.0001f;
-    if(fabs(1.0f) - sum < thresh) {
+    if(fabs(1.0f - sum) < thresh) {
         return q;
     }
     float mag = sqrt(sum);
@@ -392,6 +392,31 @@ mat4 perspective(float fovy, float aspect, float near, float far) {
     return m;
 }
 
+/**
+ *  The same as perspective but with depth reversed in to [0, 1],
+ *  see ClipDepth. A far plane of infinite_far (or anything not
+ *  beyond near) leaves depth as near / distance, which never
+ *  quite reaches 0 however far away something is.
+ */
+mat4 perspective_reverse_z(float fovy, float aspect, float near, float far) {
+    float fov_rad = fovy * one_deg_in_rad;
+    float range = tan (fov_rad / 2.0f) * near;
+    mat4 m = zero_mat4 ();
+    m.m[0] = (2.0f * near) / (range * aspect + range * aspect);
+    m.m[5] = near / range;
+    m.m[11] = -1.0f;
+    
+    if(far > near) {
+        m.m[10] = near / (far - near);
+        m.m[14] = (far * near) / (far - near);
+    }
+    else {
+        m.m[10] = 0.0f;
+        m.m[14] = near;
+    }
+    return m;
+}
+
 float determinant(const mat4 &mm) {
     return
         mm.m[12] * mm.m[9] * mm.m[6] * mm.m[3] -
@@ -527,6 +552,26 @@ mat4 transpose(const mat4 &mm) {
     );
 }
 
+/**
+ *  Inverse of a matrix that only rotates and then translates,
+ *  like a camera's. The rotation part is orthonormal so its
+ *  inverse is its transpose, and the translation is undone by
+ *  moving back along it in the rotated frame, which is far
+ *  cheaper than the general inverse.
+ */
+mat4 rigid_inverse(const mat4 &mm) {
+    mat4 result = identity_mat4();
+    for(int col = 0; col < 3; col++) {
+        for(int row = 0; row < 3; row++) {
+            result.m[col * 4 + row] = mm.m[row * 4 + col];
+        }
+    }
+    for(int i = 0; i < 3; i++) {
+        result.m[12 + i] = -(mm.m[i * 4] * mm.m[12] + mm.m[i * 4 + 1] * mm.m[13] + mm.m[i * 4 + 2] * mm.m[14]);
+    }
+    return result;
+}
+
 mat4 rotate_x_deg(const mat4 &m, float deg) {
     float rad = deg * one_deg_in_rad;
     mat4 m_r = identity_mat4();
@@ -590,7 +635,44 @@ mat4 look_at(const vec3 &cam_pos, vec3 target_pos, const vec3 &up) {
 }
 
 versor quat_from_axis_rad(float radians, float x, float y, float z) {
-    return versor();
+    versor result;
+    result.q[0] = cosf(radians / 2.0f);
+    result.q[1] = sinf(radians / 2.0f) * x;
+    result.q[2] = sinf(radians / 2.0f) * y;
+    result.q[3] = sinf(radians / 2.0f) * z;
+    return result;
+}
+
+versor quat_from_axis_deg(float degrees, float x, float y, float z) {
+    return quat_from_axis_rad(one_deg_in_rad * degrees, x, y, z);
+}
+
+/**
+ *  Rotates around x first, then y, then z, which matches
+ *  the rotation matrices that Matrices puts together.
+ */
+versor quat_from_euler_deg(float x_deg, float y_deg, float z_deg) {
+    versor qx = quat_from_axis_deg(x_deg, 1.0f, 0.0f, 0.0f);
+    versor qy = quat_from_axis_deg(y_deg, 0.0f, 1.0f, 0.0f);
+    versor qz = quat_from_axis_deg(z_deg, 0.0f, 0.0f, 1.0f);
+    return (qz * qy) * qx;
+}
+
+/**
+ *  Puts together translation * rotation * scale
+ *  without multiplying any matrices.
+ */
+mat4 compose_trs(const vec3 &t, const versor &r, const vec3 &s) {
+    mat4 m = quat_to_mat4(r);
+    for(int col = 0; col < 3; col++) {
+        m.m[col * 4] *= s.v[col];
+        m.m[col * 4 + 1] *= s.v[col];
+        m.m[col * 4 + 2] *= s.v[col];
+    }
+    m.m[12] = t.v[0];
+    m.m[13] = t.v[1];
+    m.m[14] = t.v[2];
+    return m;
 }
 
 mat4 quat_to_mat4(const versor &q) {
@@ -655,11 +737,11 @@ versor slerp(versor &q, versor &r, float t) {
     }
     
     float half_theta = acos(cos_half_theta);
-    float a = sin(1.0f -t) * half_theta / sin_half_theta;
+    float a = sin((1.0f - t) * half_theta) / sin_half_theta;
     float b = sin(t * half_theta) / sin_half_theta;
     
     for(int i = 0; i < 4; i++) {
-        result.q[i] = q.q[i] * a * r.q[i] * b;
+        result.q[i] = q.q[i] * a + r.q[i] * b;
     }
     
     return result;
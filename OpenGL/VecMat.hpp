@@ -91,6 +91,26 @@ struct versor {
     float q[4];
 };
 
+/**
+ *  How a projection lays out depth in clip space.
+ *
+ *  -   Standard maps near to -1 and far to 1, the GL default.
+ *  -   Reversed maps near to 1 and far to 0, for a [0, 1] clip
+ *      range (glClipControl) and a GL_GREATER depth test. With a
+ *      float depth buffer this spreads precision evenly over
+ *      the whole view distance.
+ */
+enum ClipDepth {
+    CLIP_DEPTH_STANDARD,
+    CLIP_DEPTH_REVERSED
+};
+
+/**
+ *  Passed as far to perspective_reverse_z
+ *  to push the far plane out to infinity.
+ */
+#define infinite_far 0.0f
+
 /**
  *  Functions for vectors
  */
@@ -112,10 +132,12 @@ mat4 zero_mat4();
 mat4 identity_mat4();
 mat4 translate(const mat4 &m, const vec3 &v);
 mat4 perspective(float fovy, float aspect, float near, float far);
+mat4 perspective_reverse_z(float fovy, float aspect, float near, float far = infinite_far);
 mat4 look_at(const vec3 &cam_pos, vec3 target_pos, const vec3 &up);
 float determinant(const mat4 &mm);
 mat4 inverse(const mat4 &mm);
 mat4 transpose(const mat4 &mm);
+mat4 rigid_inverse(const mat4 &mm);
 mat4 rotate_x_deg(const mat4 &m, float deg);
 mat4 rotate_y_deg(const mat4 &m, float deg);
 mat4 rotate_z_deg(const mat4 &m, float deg);
@@ -126,7 +148,9 @@ mat4 scale(const mat4 &m, const vec3 &v);
  */
 versor quat_from_axis_rad(float radians, float x, float y, float z);
 versor quat_from_axis_deg(float degress, float x, float y, float z);
+versor quat_from_euler_deg(float x_deg, float y_deg, float z_deg);
 mat4 quat_to_mat4(const versor &q);
+mat4 compose_trs(const vec3 &t, const versor &r, const vec3 &s);
 float dot(const versor &q, const versor &r);
 versor slerp(versor &q, versor &r, float t);
 versor normalise(versor &q);
@@ -10,7 +10,7 @@
 #include <iostream>
 #include <vector>
 #include <stdio.h>
-#include <OpenGL/gl3.h>
+#include "GLPlatform.h"
 #include <GLFW/glfw3.h>
 #include <math.h>
 #include "ShaderLoader.hpp"
@@ -315,7 +315,7 @@ int vertex_buffer_objects_main(void) {
          *  printing the program details along the way.
          */
         string vertex_shader_string = shader_loader_vbo.load("vertex_buffer_objects.vert");
-        string fragment_shader_string = shader_loader_vbo.load("vertex_buffer_objects.frag");
+        string fragment_shader_string = shader_loader_vbo.load("vertex_colour.frag");
         const char *vertex_shader_source = vertex_shader_string.c_str();
         const char *fragment_shader_source = fragment_shader_string.c_str();
         
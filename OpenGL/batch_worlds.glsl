@@ -0,0 +1,20 @@
+/**
+ *  The world matrix of every mesh in a StaticBatch,
+ *  one column per texel.
+ */
+uniform samplerBuffer world_matrices;
+
+/**
+ *  Where this frame's matrices start in world_matrices.
+ */
+uniform int world_base;
+
+mat4 batch_world(uint slot) {
+    int base = world_base + int(slot) * 4;
+    return mat4(
+        texelFetch(world_matrices, base),
+        texelFetch(world_matrices, base + 1),
+        texelFetch(world_matrices, base + 2),
+        texelFetch(world_matrices, base + 3)
+    );
+}
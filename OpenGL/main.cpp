@@ -6,18 +6,21 @@
 //  Copyright © 2017 Matt Finucane. All rights reserved.
 //
 
+#include <iostream>
 #include <vector>
+#include <string>
 #include "Points.hpp"
 #include "Meshes.h"
 #include "Shapes.hpp"
 #include "Structs.h"
 #include "Matrix.hpp"
 #include "Shaders.hpp"
-#include "ObjectLoader.hpp"
 #include "VertexBufferObjects.hpp"
 #include "CubeTransformDemo.hpp"
 #include "CameraPerspectiveDemo.hpp"
 #include "QuaternionDemo.hpp"
+#include "Input.hpp"
+#include "TraceLog.hpp"
 
 using namespace std;
 
@@ -55,23 +58,11 @@ int runCubeTransformDemo(void) {
 }
 
 int runModelLoadDemo(void) {
-    ObjectLoader loader;
-    loader.load("structure.obj");
-    
-    vector<GLfloat> vertices = loader.getVertices();
-    vector<GLfloat> colours(vertices.size());
-    
-    int i = 0;
-    
-    transform(begin(colours), end(colours), begin(colours), [&i](GLfloat c) {
-        GLfloat x = 0;
-        if(i++ == 0) x = 1.0f;
-        else if(i % 4 == 0) x =  1.0f;
-        else if(i % 8 == 0) x = 1.0f;
-        return x;
-    });
-    
-    CubeTransformDemo *model_demo = new CubeTransformDemo(vertices, colours);
+    /**
+     *  The model is loaded in the background
+     *  once the window is open.
+     */
+    CubeTransformDemo *model_demo = new CubeTransformDemo("structure.obj");
     int run = model_demo->run();
     delete(model_demo);
     return run;
@@ -242,7 +233,42 @@ int runQuaternionDemo(void) {
     return 0;
 }
 
+/**
+ *  --record <file> saves the session's input, and --replay <file>
+ *  plays it back and prints how long the frames took. --trace <file>
+ *  writes the TRACE points out, to be read with TraceDecode.
+ *
+ *  Returns false if one of them couldn't start, rather than
+ *  running without what was asked for.
+ */
+bool setupOptions(int argc, const char * argv[]) {
+    for(int i = 1; i + 1 < argc; i++) {
+        string option = argv[i];
+        bool started = true;
+        if("--record" == option) {
+            started = Input::getInstance().startRecording(argv[++i]);
+        }
+        else if("--replay" == option) {
+            started = Input::getInstance().startReplay(argv[++i]);
+        }
+        else if("--trace" == option) {
+            started = TraceLog::start(argv[++i]);
+        }
+        
+        if(!started) {
+            cerr << "Could not start " << option << " " << argv[i] << ", exiting." << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 int main(int argc, const char * argv[]) {
+    if(!setupOptions(argc, argv)) {
+        TraceLog::stop();
+        return 1;
+    }
+
 //    return shapes_main();
 //    return shaders_main();
 //    return vertex_buffer_objects_main();
@@ -252,4 +278,6 @@ int main(int argc, const char * argv[]) {
 //    int mo_run = distanceCalculatorDemo();
 //    int run = runCameraPerspectiveDemo();
     int run = runQuaternionDemo();
+    TraceLog::stop();
+    return run;
 }
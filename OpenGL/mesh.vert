@@ -0,0 +1,26 @@
+#version 410
+layout(location = 0) in vec3 vertex_position;
+layout(location = 1) in vec3 vertex_colour;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+/**
+ *  Meshes drawn through a StaticBatch find their world
+ *  matrix from the slot they were packed in to.
+ */
+#ifdef BATCHED_WORLDS
+layout(location = 2) in uint draw_slot;
+#include "batch_worlds.glsl"
+#endif
+
+out vec3 colour;
+
+void main() {
+    colour = vertex_colour;
+#ifdef BATCHED_WORLDS
+    gl_Position = projection * view * batch_world(draw_slot) * vec4(vertex_position, 1.0f);
+#else
+    gl_Position = projection * view * vec4(vertex_position, 1.0f);
+#endif
+}
@@ -0,0 +1,106 @@
+//
+//  BVHBenchmarks.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <random>
+#include <vector>
+#include "Benchmark.hpp"
+#include "BVH.hpp"
+
+using namespace std;
+
+/**
+ *  Enough objects that culling them one by one costs
+ *  more than a frame can spare.
+ */
+#define bvh_benchmark_items 100000
+
+/**
+ *  Small boxes spread through a 2000 unit cube, seen by
+ *  a camera in the middle that can see about a tenth of them.
+ */
+static vector<AABB> benchmark_scene(void) {
+    mt19937 random(1);
+    uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+    
+    vector<AABB> bounds(bvh_benchmark_items);
+    for(auto &box: bounds) {
+        for(int i = 0; i < 3; i++) {
+            box.min.v[i] = position(random);
+            box.max.v[i] = box.min.v[i] + 2.0f;
+        }
+    }
+    return bounds;
+}
+
+static Frustum benchmark_frustum(void) {
+    return Frustum(perspective(67.0f, 1.5f, 0.1f, 1000.0f));
+}
+
+BENCHMARK(bvh_build_100k) {
+    vector<AABB> bounds = benchmark_scene();
+    BVH bvh;
+    
+    timer.start();
+    bvh.build(bounds);
+    timer.stop();
+}
+
+BENCHMARK(bvh_refit_100k) {
+    vector<AABB> bounds = benchmark_scene();
+    BVH bvh;
+    bvh.build(bounds);
+    
+    timer.start();
+    bvh.refit(bounds);
+    timer.stop();
+}
+
+BENCHMARK(bvh_cull_100k) {
+    vector<AABB> bounds = benchmark_scene();
+    BVH bvh;
+    bvh.build(bounds);
+    Frustum frustum = benchmark_frustum();
+    vector<int> visible;
+    
+    timer.start();
+    bvh.cull(frustum, visible);
+    timer.stop();
+    keep(visible.size());
+}
+
+BENCHMARK(brute_force_cull_100k) {
+    vector<AABB> bounds = benchmark_scene();
+    Frustum frustum = benchmark_frustum();
+    vector<int> visible;
+    
+    timer.start();
+    for(int i = 0; i < (int)bounds.size(); i++) {
+        if(frustum.boxVisible(bounds[i])) {
+            visible.push_back(i);
+        }
+    }
+    timer.stop();
+    keep(visible.size());
+}
+
+BENCHMARK(bvh_raycast_1k_rays_100k) {
+    vector<AABB> bounds = benchmark_scene();
+    BVH bvh;
+    bvh.build(bounds);
+    
+    mt19937 random(2);
+    uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    BVHHit hit;
+    
+    timer.start();
+    for(int i = 0; i < 1000; i++) {
+        Ray ray = ray_from_points(vec3(0.0f, 0.0f, 0.0f), vec3(direction(random), direction(random), direction(random)));
+        keep(bvh.raycast(ray, 2000.0f, hit));
+    }
+    timer.stop();
+}
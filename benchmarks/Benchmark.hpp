@@ -0,0 +1,66 @@
+//
+//  Benchmark.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef Benchmark_hpp
+#define Benchmark_hpp
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/**
+ *  Each BENCHMARK block is one case. The runner calls it a few
+ *  times and prints the fastest, which is the least disturbed by
+ *  whatever else the machine was doing. A case that needs setup
+ *  does it first and then times only its loop with a BenchmarkTimer.
+ */
+#define benchmark_runs 5
+
+struct BenchmarkTimer {
+    std::chrono::steady_clock::time_point started;
+    double elapsed_ms = 0.0;
+    
+    void start(void) {
+        started = std::chrono::steady_clock::now();
+    }
+    
+    void stop(void) {
+        elapsed_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    }
+};
+
+struct BenchmarkCase {
+    const char *name;
+    void (*run)(BenchmarkTimer &timer);
+};
+
+inline std::vector<BenchmarkCase>& benchmark_cases(void) {
+    static std::vector<BenchmarkCase> cases;
+    return cases;
+}
+
+struct BenchmarkRegistrar {
+    BenchmarkRegistrar(const char *name, void (*run)(BenchmarkTimer &timer)) {
+        benchmark_cases().push_back({name, run});
+    }
+};
+
+/**
+ *  Stops the compiler throwing away work whose result is unused.
+ */
+template<typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+#define BENCHMARK(benchmark_name) \
+    static void benchmark_name(BenchmarkTimer &timer); \
+    static BenchmarkRegistrar benchmark_name##_registrar(#benchmark_name, benchmark_name); \
+    static void benchmark_name(BenchmarkTimer &timer)
+
+#endif /* Benchmark_hpp */
@@ -0,0 +1,37 @@
+//
+//  Benchmarks.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstring>
+#include "Benchmark.hpp"
+
+using namespace std;
+
+/**
+ *  Runs every case, or only those whose names contain the
+ *  first argument, printing the best time of each.
+ */
+int main(int argc, const char * argv[]) {
+    const char *filter = argc > 1 ? argv[1] : nullptr;
+    
+    for(auto &benchmark: benchmark_cases()) {
+        if(filter && !strstr(benchmark.name, filter)) {
+            continue;
+        }
+        
+        double best = 0.0;
+        for(int run = 0; run < benchmark_runs; run++) {
+            BenchmarkTimer timer;
+            benchmark.run(timer);
+            best = run ? min(best, timer.elapsed_ms) : timer.elapsed_ms;
+        }
+        printf("%-32s %10.3f ms\n", benchmark.name, best);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,95 @@
+//
+//  MathBenchmarks.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <vector>
+#include "Benchmark.hpp"
+#include "VecMat.hpp"
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+
+using namespace std;
+
+#define math_benchmark_count 100000
+
+/**
+ *  Spheres spread over a square around a camera at
+ *  the origin, so roughly a quarter of them are visible.
+ */
+static BoundingSpheres scattered_spheres(int count) {
+    BoundingSpheres spheres;
+    unsigned int seed = 1;
+    for(int i = 0; i < count; i++) {
+        seed = seed * 1103515245 + 12345;
+        float x = (float)((seed >> 8) % 2000) - 1000.0f;
+        seed = seed * 1103515245 + 12345;
+        float z = (float)((seed >> 8) % 2000) - 1000.0f;
+        spheres.push({vec3(x, 0.0f, z), 2.0f});
+    }
+    return spheres;
+}
+
+BENCHMARK(mat4_multiply_100k) {
+    mat4 a = rotate_y_deg(identity_mat4(), 10.0f);
+    mat4 b = translate(identity_mat4(), vec3(1.0f, 2.0f, 3.0f));
+    
+    timer.start();
+    for(int i = 0; i < math_benchmark_count; i++) {
+        b = a * b;
+        keep(b);
+    }
+    timer.stop();
+}
+
+BENCHMARK(compose_trs_100k) {
+    versor r = quat_from_axis_deg(10.0f, 0.0f, 1.0f, 0.0f);
+    mat4 m;
+    
+    timer.start();
+    for(int i = 0; i < math_benchmark_count; i++) {
+        m = compose_trs(vec3((float)i, 0.0f, 0.0f), r, vec3(1.0f, 1.0f, 1.0f));
+        keep(m);
+    }
+    timer.stop();
+}
+
+BENCHMARK(inverse_100k) {
+    mat4 m = compose_trs(vec3(1.0f, 2.0f, 3.0f), quat_from_axis_deg(30.0f, 0.0f, 1.0f, 0.0f), vec3(1.0f, 1.0f, 1.0f));
+    mat4 result;
+    
+    timer.start();
+    for(int i = 0; i < math_benchmark_count; i++) {
+        m.m[12] = (float)i;
+        result = inverse(m);
+        keep(result);
+    }
+    timer.stop();
+}
+
+BENCHMARK(rigid_inverse_100k) {
+    mat4 m = compose_trs(vec3(1.0f, 2.0f, 3.0f), quat_from_axis_deg(30.0f, 0.0f, 1.0f, 0.0f), vec3(1.0f, 1.0f, 1.0f));
+    mat4 result;
+    
+    timer.start();
+    for(int i = 0; i < math_benchmark_count; i++) {
+        m.m[12] = (float)i;
+        result = rigid_inverse(m);
+        keep(result);
+    }
+    timer.stop();
+}
+
+BENCHMARK(frustum_cull_spheres_100k) {
+    Frustum frustum(perspective(67.0f, 1.5f, 0.1f, 1000.0f));
+    BoundingSpheres spheres = scattered_spheres(math_benchmark_count);
+    vector<unsigned char> visible;
+    
+    timer.start();
+    size_t count = frustum.cull(spheres, visible);
+    timer.stop();
+    keep(count);
+}
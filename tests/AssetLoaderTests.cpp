@@ -0,0 +1,87 @@
+//
+//  AssetLoaderTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "Check.hpp"
+#include "AssetLoader.hpp"
+
+using namespace std;
+
+#define test_text_path "asset_loader_test.txt"
+
+static void write_text(const string &contents) {
+    ofstream file(test_text_path, ios::out | ios::trunc);
+    file << contents;
+}
+
+TEST(update_uploads_every_asset) {
+    write_text("hello\n");
+    
+    AssetLoader loader;
+    int uploads = 0;
+    string text;
+    for(int i = 0; i < 8; i++) {
+        loader.load(test_text_path, ASSET_TEXT, [&](AssetData &data) {
+            CHECK(data.loaded);
+            text = data.text;
+            uploads++;
+        });
+    }
+    loader.load("no_such_file.txt", ASSET_TEXT, [&](AssetData &data) {
+        CHECK(!data.loaded);
+        uploads++;
+    });
+    
+    for(int tries = 0; !loader.done() && tries < 5000; tries++) {
+        loader.update(1000.0);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    
+    CHECK(loader.done());
+    CHECK(9 == uploads);
+    CHECK(0 == text.compare(0, 6, "hello\n"));
+    CHECK_NEAR(1.0f, loader.progress(), 1e-6f);
+    remove(test_text_path);
+}
+
+/**
+ *  More assets than the finished queue holds, none of them
+ *  taken, leaves a loader thread waiting for room. Going out
+ *  of scope has to stop it rather than wait on it for good.
+ */
+TEST(destroying_with_a_full_queue_returns) {
+    write_text("x");
+    
+    const int count = 300;
+    {
+        AssetLoader loader;
+        for(int i = 0; i < count; i++) {
+            loader.load(test_text_path, ASSET_BINARY, nullptr);
+        }
+        
+        /**
+         *  Without loader threads nothing is read until
+         *  update, so there is nothing to wait for.
+         */
+#if !defined(OPENGL_SINGLE_THREADED)
+        for(int tries = 0; loader.progress() < 0.5f * 257 / count && tries < 5000; tries++) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+#endif
+    }
+    
+    CHECK(true);
+    remove(test_text_path);
+}
+
+int main(void) {
+    return run_tests();
+}
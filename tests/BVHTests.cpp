@@ -0,0 +1,225 @@
+//
+//  BVHTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <algorithm>
+#include <random>
+#include "Check.hpp"
+#include "BVH.hpp"
+
+using namespace std;
+
+#define bvh_test_items 5000
+
+/**
+ *  Boxes of mixed sizes scattered through a 400 unit cube,
+ *  the same every run.
+ */
+static vector<AABB> random_scene(mt19937 &random) {
+    uniform_real_distribution<float> position(-200.0f, 200.0f);
+    uniform_real_distribution<float> size(0.1f, 8.0f);
+    
+    vector<AABB> bounds(bvh_test_items);
+    for(auto &box: bounds) {
+        for(int i = 0; i < 3; i++) {
+            box.min.v[i] = position(random);
+            box.max.v[i] = box.min.v[i] + size(random);
+        }
+    }
+    return bounds;
+}
+
+static Frustum random_frustum(mt19937 &random) {
+    uniform_real_distribution<float> angle(0.0f, 360.0f);
+    uniform_real_distribution<float> position(-150.0f, 150.0f);
+    
+    mat4 view = rotate_y_deg(identity_mat4(), angle(random));
+    view = rotate_x_deg(view, angle(random) / 8.0f);
+    view = translate(identity_mat4(), vec3(position(random), position(random), position(random))) * view;
+    return Frustum(perspective(67.0f, 1.5f, 0.5f, 250.0f) * inverse(view));
+}
+
+static vector<int> brute_force_cull(const vector<AABB> &bounds, const Frustum &frustum) {
+    vector<int> visible;
+    for(int i = 0; i < (int)bounds.size(); i++) {
+        if(frustum.boxVisible(bounds[i])) {
+            visible.push_back(i);
+        }
+    }
+    return visible;
+}
+
+static vector<BVHHit> brute_force_ray(const vector<AABB> &bounds, const Ray &ray, float max_distance) {
+    vector<BVHHit> hits;
+    for(int i = 0; i < (int)bounds.size(); i++) {
+        float distance;
+        if(ray_aabb(ray, bounds[i], max_distance, distance)) {
+            hits.push_back({i, distance});
+        }
+    }
+    sort(begin(hits), end(hits), [](const BVHHit &a, const BVHHit &b) {
+        return a.distance < b.distance;
+    });
+    return hits;
+}
+
+static vector<int> sorted(vector<int> items) {
+    sort(begin(items), end(items));
+    return items;
+}
+
+static Ray random_ray(mt19937 &random) {
+    uniform_real_distribution<float> position(-250.0f, 250.0f);
+    vec3 from(position(random), position(random), position(random));
+    vec3 to(position(random) / 4.0f, position(random) / 4.0f, position(random) / 4.0f);
+    return ray_from_points(from, to);
+}
+
+TEST(build_covers_every_item) {
+    mt19937 random(1);
+    vector<AABB> bounds = random_scene(random);
+    
+    BVH bvh;
+    bvh.build(bounds);
+    CHECK(bounds.size() == bvh.size());
+    
+    AABB all = empty_aabb();
+    for(auto &box: bounds) {
+        all = aabb_merge(all, box);
+    }
+    AABB root = bvh.bounds();
+    for(int i = 0; i < 3; i++) {
+        CHECK(root.min.v[i] == all.min.v[i]);
+        CHECK(root.max.v[i] == all.max.v[i]);
+    }
+}
+
+TEST(cull_matches_brute_force) {
+    mt19937 random(2);
+    vector<AABB> bounds = random_scene(random);
+    BVH bvh;
+    bvh.build(bounds);
+    
+    size_t seen = 0;
+    for(int i = 0; i < 50; i++) {
+        Frustum frustum = random_frustum(random);
+        vector<int> visible;
+        bvh.cull(frustum, visible);
+        
+        vector<int> expected = brute_force_cull(bounds, frustum);
+        CHECK(expected == sorted(visible));
+        seen += expected.size();
+    }
+    CHECK(seen > 0);
+}
+
+TEST(multi_frustum_cull_matches_brute_force) {
+    mt19937 random(3);
+    vector<AABB> bounds = random_scene(random);
+    BVH bvh;
+    bvh.build(bounds);
+    
+    vector<Frustum> frustums;
+    for(int i = 0; i < bvh_max_frusta; i++) {
+        frustums.push_back(random_frustum(random));
+    }
+    
+    vector<vector<int>> visible;
+    bvh.cull(frustums, visible);
+    CHECK(frustums.size() == visible.size());
+    for(size_t i = 0; i < frustums.size(); i++) {
+        CHECK(brute_force_cull(bounds, frustums[i]) == sorted(visible[i]));
+    }
+}
+
+TEST(refit_matches_brute_force) {
+    mt19937 random(4);
+    vector<AABB> bounds = random_scene(random);
+    BVH bvh;
+    bvh.build(bounds);
+    
+    uniform_real_distribution<float> drift(-5.0f, 5.0f);
+    for(auto &box: bounds) {
+        for(int i = 0; i < 3; i++) {
+            float d = drift(random);
+            box.min.v[i] += d;
+            box.max.v[i] += d;
+        }
+    }
+    bvh.refit(bounds);
+    
+    for(int i = 0; i < 20; i++) {
+        Frustum frustum = random_frustum(random);
+        vector<int> visible;
+        bvh.cull(frustum, visible);
+        CHECK(brute_force_cull(bounds, frustum) == sorted(visible));
+    }
+}
+
+TEST(raycast_finds_nearest) {
+    mt19937 random(5);
+    vector<AABB> bounds = random_scene(random);
+    BVH bvh;
+    bvh.build(bounds);
+    
+    int hits = 0;
+    for(int i = 0; i < 200; i++) {
+        Ray ray = random_ray(random);
+        vector<BVHHit> expected = brute_force_ray(bounds, ray, 1000.0f);
+        
+        BVHHit hit;
+        bool found = bvh.raycast(ray, 1000.0f, hit);
+        CHECK(found == !expected.empty());
+        if(found && !expected.empty()) {
+            CHECK_NEAR(hit.distance, expected[0].distance, 1e-4);
+            hits++;
+        }
+    }
+    CHECK(hits > 0);
+}
+
+TEST(raycast_all_matches_brute_force) {
+    mt19937 random(6);
+    vector<AABB> bounds = random_scene(random);
+    BVH bvh;
+    bvh.build(bounds);
+    
+    for(int i = 0; i < 200; i++) {
+        Ray ray = random_ray(random);
+        const float max_distance = 300.0f;
+        vector<BVHHit> expected = brute_force_ray(bounds, ray, max_distance);
+        
+        vector<BVHHit> hits;
+        bvh.raycastAll(ray, max_distance, hits);
+        CHECK(expected.size() == hits.size());
+        
+        vector<int> expected_items;
+        vector<int> hit_items;
+        for(size_t j = 0; j < hits.size() && j < expected.size(); j++) {
+            CHECK_NEAR(hits[j].distance, expected[j].distance, 1e-4);
+            expected_items.push_back(expected[j].item);
+            hit_items.push_back(hits[j].item);
+        }
+        CHECK(sorted(expected_items) == sorted(hit_items));
+    }
+}
+
+TEST(empty_tree_finds_nothing) {
+    BVH bvh;
+    bvh.build({});
+    
+    vector<int> visible;
+    bvh.cull(Frustum(perspective(67.0f, 1.0f, 0.1f, 100.0f)), visible);
+    CHECK(visible.empty());
+    
+    BVHHit hit;
+    CHECK(!bvh.raycast(ray_from_points(vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, -1.0f)), 100.0f, hit));
+}
+
+int main(void) {
+    return run_tests();
+}
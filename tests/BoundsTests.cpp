@@ -0,0 +1,183 @@
+//
+//  BoundsTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "Check.hpp"
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+
+using namespace std;
+
+static AABB box(float x0, float y0, float z0, float x1, float y1, float z1) {
+    AABB result;
+    result.min = vec3(x0, y0, z0);
+    result.max = vec3(x1, y1, z1);
+    return result;
+}
+
+/**
+ *  A camera at the origin looking down -z, seeing from 1 to 100.
+ */
+static Frustum camera_frustum(ClipDepth depth = CLIP_DEPTH_STANDARD) {
+    mat4 projection = CLIP_DEPTH_STANDARD == depth ?
+        perspective(90.0f, 1.0f, 1.0f, 100.0f) :
+        perspective_reverse_z(90.0f, 1.0f, 1.0f, 100.0f);
+    return Frustum(projection, depth);
+}
+
+TEST(aabb_from_points_and_merge) {
+    vector<Point> points = {{1.0f, -2.0f, 3.0f}, {-1.0f, 4.0f, 0.0f}, {0.0f, 0.0f, -5.0f}};
+    AABB a = aabb_from_points(points);
+    CHECK(-1.0f == a.min.v[0] && -2.0f == a.min.v[1] && -5.0f == a.min.v[2]);
+    CHECK(1.0f == a.max.v[0] && 4.0f == a.max.v[1] && 3.0f == a.max.v[2]);
+    
+    AABB merged = aabb_merge(a, box(5.0f, 5.0f, 5.0f, 6.0f, 6.0f, 6.0f));
+    CHECK(-1.0f == merged.min.v[0] && 6.0f == merged.max.v[2]);
+    
+    CHECK(aabb_is_empty(empty_aabb()));
+    CHECK(!aabb_is_empty(a));
+    AABB same = aabb_merge(empty_aabb(), a);
+    CHECK(same.min.v[1] == a.min.v[1] && same.max.v[1] == a.max.v[1]);
+}
+
+TEST(aabb_measurements) {
+    AABB b = box(0.0f, 0.0f, 0.0f, 2.0f, 4.0f, 6.0f);
+    vec3 c = aabb_centre(b);
+    vec3 e = aabb_extent(b);
+    CHECK(1.0f == c.v[0] && 2.0f == c.v[1] && 3.0f == c.v[2]);
+    CHECK(1.0f == e.v[0] && 2.0f == e.v[1] && 3.0f == e.v[2]);
+    CHECK_NEAR(aabb_surface_area(b), 2.0f * (8.0f + 24.0f + 12.0f), 1e-5);
+    CHECK(aabb_contains(b, vec3(1.0f, 1.0f, 1.0f)));
+    CHECK(!aabb_contains(b, vec3(3.0f, 1.0f, 1.0f)));
+}
+
+TEST(transform_aabb_encloses_corners) {
+    AABB b = box(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
+    mat4 m = translate(rotate_y_deg(identity_mat4(), 45.0f), vec3(10.0f, 0.0f, 0.0f));
+    AABB t = transform_aabb(b, m);
+    
+    const float half_diagonal = sqrtf(2.0f);
+    CHECK_NEAR(t.min.v[0], 10.0f - half_diagonal, 1e-5);
+    CHECK_NEAR(t.max.v[0], 10.0f + half_diagonal, 1e-5);
+    CHECK_NEAR(t.min.v[1], -1.0f, 1e-5);
+    CHECK_NEAR(t.max.v[2], half_diagonal, 1e-5);
+}
+
+TEST(spheres_from_bounds) {
+    AABB b = box(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
+    BoundingSphere s = sphere_from_aabb(b);
+    CHECK_NEAR(s.radius, sqrtf(3.0f), 1e-6);
+    
+    vector<Point> points = {{1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    BoundingSphere tight = sphere_from_points(points, aabb_from_points(points));
+    CHECK(tight.radius < s.radius);
+    
+    mat4 m = identity_mat4();
+    m.m[0] = 3.0f;
+    m.m[13] = 5.0f;
+    BoundingSphere moved = transform_sphere(s, m);
+    CHECK_NEAR(moved.centre.v[1], 5.0f, 1e-6);
+    CHECK_NEAR(moved.radius, 3.0f * sqrtf(3.0f), 1e-5);
+}
+
+TEST(ray_hits_and_misses_boxes) {
+    AABB b = box(-1.0f, -1.0f, -10.0f, 1.0f, 1.0f, -8.0f);
+    Ray ray = ray_from_points(vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, -1.0f));
+    
+    float distance = 0.0f;
+    CHECK(ray_aabb(ray, b, 100.0f, distance));
+    CHECK_NEAR(distance, 8.0f, 1e-5);
+    CHECK(!ray_aabb(ray, b, 5.0f, distance));
+    
+    Ray away = ray_from_points(vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f));
+    CHECK(!ray_aabb(away, b, 100.0f, distance));
+    
+    Ray beside = ray_from_points(vec3(3.0f, 0.0f, 0.0f), vec3(3.0f, 0.0f, -1.0f));
+    CHECK(!ray_aabb(beside, b, 100.0f, distance));
+}
+
+TEST(ray_from_screen_centre_looks_forward) {
+    mat4 projection = perspective(90.0f, 1.0f, 1.0f, 100.0f);
+    Ray ray = ray_from_screen(50.0f, 50.0f, 100, 100, inverse(projection));
+    CHECK_NEAR(ray.direction.v[0], 0.0f, 1e-4);
+    CHECK_NEAR(ray.direction.v[1], 0.0f, 1e-4);
+    CHECK_NEAR(ray.direction.v[2], -1.0f, 1e-4);
+}
+
+TEST(frustum_planes_face_inwards) {
+    Frustum frustum = camera_frustum();
+    CHECK(frustum.sphereVisible({vec3(0.0f, 0.0f, -50.0f), 1.0f}));
+    CHECK(!frustum.sphereVisible({vec3(0.0f, 0.0f, 50.0f), 1.0f}));
+    CHECK(!frustum.sphereVisible({vec3(0.0f, 0.0f, -200.0f), 1.0f}));
+    CHECK(!frustum.sphereVisible({vec3(100.0f, 0.0f, -50.0f), 1.0f}));
+    CHECK(frustum.sphereVisible({vec3(0.0f, 0.0f, -0.5f), 1.0f}));
+    
+    CHECK(frustum.boxVisible(box(-1.0f, -1.0f, -51.0f, 1.0f, 1.0f, -49.0f)));
+    CHECK(!frustum.boxVisible(box(-1.0f, -1.0f, 49.0f, 1.0f, 1.0f, 51.0f)));
+}
+
+TEST(frustum_classifies_boxes) {
+    Frustum frustum = camera_frustum();
+    
+    unsigned int mask = all_frustum_planes;
+    CHECK(INSIDE == frustum.classifyBox(box(-1.0f, -1.0f, -11.0f, 1.0f, 1.0f, -9.0f), mask));
+    CHECK(0 == mask);
+    
+    mask = all_frustum_planes;
+    CHECK(OUTSIDE == frustum.classifyBox(box(-1.0f, -1.0f, 9.0f, 1.0f, 1.0f, 11.0f), mask));
+    
+    mask = all_frustum_planes;
+    CHECK(INTERSECTS == frustum.classifyBox(box(-1.0f, -1.0f, -101.0f, 1.0f, 1.0f, -99.0f), mask));
+    CHECK(mask & (1 << PLANE_FAR));
+    CHECK(!(mask & (1 << PLANE_NEAR)));
+}
+
+TEST(reversed_frustum_matches_standard) {
+    Frustum standard = camera_frustum();
+    Frustum reversed = camera_frustum(CLIP_DEPTH_REVERSED);
+    for(int i = 0; i < 6; i++) {
+        vec4 a = standard.plane((FrustumPlane)i);
+        vec4 b = reversed.plane((FrustumPlane)i);
+        float la = sqrtf(a.v[0] * a.v[0] + a.v[1] * a.v[1] + a.v[2] * a.v[2]);
+        float lb = sqrtf(b.v[0] * b.v[0] + b.v[1] * b.v[1] + b.v[2] * b.v[2]);
+        for(int j = 0; j < 4; j++) {
+            CHECK_NEAR(a.v[j] / la, b.v[j] / lb, 1e-4);
+        }
+    }
+}
+
+TEST(sphere_cull_matches_single_tests) {
+    Frustum frustum = camera_frustum();
+    BoundingSpheres spheres;
+    vector<BoundingSphere> each;
+    
+    unsigned int seed = 7;
+    for(int i = 0; i < 1001; i++) {
+        seed = seed * 1103515245 + 12345;
+        float x = (float)((seed >> 8) % 400) - 200.0f;
+        seed = seed * 1103515245 + 12345;
+        float z = (float)((seed >> 8) % 400) - 200.0f;
+        BoundingSphere sphere = {vec3(x, 0.0f, z), 2.0f};
+        spheres.push(sphere);
+        each.push_back(sphere);
+    }
+    
+    vector<unsigned char> visible;
+    size_t count = frustum.cull(spheres, visible);
+    size_t expected = 0;
+    for(size_t i = 0; i < each.size(); i++) {
+        bool one = frustum.sphereVisible(each[i]);
+        CHECK(one == (1 == visible[i]));
+        expected += one;
+    }
+    CHECK(count == expected);
+    CHECK(count > 0 && count < each.size());
+}
+
+int main(void) {
+    return run_tests();
+}
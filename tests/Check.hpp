@@ -0,0 +1,77 @@
+//
+//  Check.hpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#ifndef Check_hpp
+#define Check_hpp
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/**
+ *  Just enough of a test framework for the unit tests, so they
+ *  build anywhere CMake does. Each test file is its own executable
+ *  made of TEST blocks, and its main returns run_tests(), which is
+ *  non-zero if any CHECK failed.
+ */
+struct TestCase {
+    const char *name;
+    void (*run)(void);
+};
+
+inline std::vector<TestCase>& test_cases(void) {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& check_failures(void) {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char *name, void (*run)(void)) {
+        test_cases().push_back({name, run});
+    }
+};
+
+inline void check_failed(const char *file, int line, const char *expression) {
+    printf("%s:%d: check failed: %s\n", file, line, expression);
+    check_failures()++;
+}
+
+inline int run_tests(void) {
+    for(auto &test: test_cases()) {
+        int before = check_failures();
+        test.run();
+        printf("%s %s\n", before == check_failures() ? "pass" : "FAIL", test.name);
+    }
+    return check_failures() ? 1 : 0;
+}
+
+#define TEST(test_name) \
+    static void test_name(void); \
+    static TestRegistrar test_name##_registrar(#test_name, test_name); \
+    static void test_name(void)
+
+#define CHECK(expression) \
+    do { \
+        if(!(expression)) { \
+            check_failed(__FILE__, __LINE__, #expression); \
+        } \
+    } while(0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+    do { \
+        if(!(std::fabs((double)(a) - (double)(b)) <= (tolerance))) { \
+            check_failed(__FILE__, __LINE__, #a " near " #b); \
+            printf("    %f and %f\n", (double)(a), (double)(b)); \
+        } \
+    } while(0)
+
+#endif /* Check_hpp */
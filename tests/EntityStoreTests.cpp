@@ -0,0 +1,190 @@
+//
+//  EntityStoreTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <map>
+#include <random>
+#include "Check.hpp"
+#include "EntityStore.hpp"
+
+using namespace std;
+
+/**
+ *  What each live entity was given, to check the
+ *  packed arrays against after things move around.
+ */
+struct EntityModel {
+    vec3 position;
+    int mesh;
+};
+
+typedef map<pair<unsigned int, unsigned int>, EntityModel> EntityModels;
+
+static pair<unsigned int, unsigned int> key(Entity entity) {
+    return make_pair(entity.index, entity.generation);
+}
+
+static Entity add(EntityStore &store, EntityModels &models, float x, int mesh) {
+    Entity entity = store.create();
+    store.setPosition(entity, vec3(x, -x, 2.0f * x));
+    store.setMesh(entity, mesh);
+    models[key(entity)] = {vec3(x, -x, 2.0f * x), mesh};
+    return entity;
+}
+
+/**
+ *  Every live entity is where the dense index says, with
+ *  its own components, and nothing else is in the arrays.
+ */
+static bool consistent(const EntityStore &store, const EntityModels &models) {
+    if(store.size() != models.size() ||
+       store.getPositions().size() != store.size() ||
+       store.getRotations().size() != store.size() ||
+       store.getScales().size() != store.size() ||
+       store.getWorlds().size() != store.size() ||
+       store.getBounds().size() != store.size() ||
+       store.getWorldBounds().size() != store.size() ||
+       store.getMeshes().size() != store.size()) {
+        return false;
+    }
+    
+    for(size_t i = 0; i < store.size(); i++) {
+        Entity entity = store.entityAt(i);
+        auto found = models.find(key(entity));
+        if(found == models.end() || (int)i != store.indexOf(entity)) {
+            return false;
+        }
+        
+        const vec3 &position = store.getPositions()[i];
+        const mat4 &world = store.getWorlds()[i];
+        if(position.v[0] != found->second.position.v[0] ||
+           position.v[1] != found->second.position.v[1] ||
+           position.v[2] != found->second.position.v[2] ||
+           world.m[12] != position.v[0] ||
+           store.getMeshes()[i] != found->second.mesh) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(destroyed_handle_is_not_alive) {
+    EntityStore store;
+    Entity entity = store.create();
+    CHECK(store.alive(entity));
+    CHECK(0 == store.indexOf(entity));
+    
+    store.destroy(entity);
+    CHECK(!store.alive(entity));
+    CHECK(-1 == store.indexOf(entity));
+    CHECK(0 == store.size());
+    
+    /**
+     *  Setting anything through a dead handle does nothing,
+     *  and destroying it again is harmless.
+     */
+    store.setPosition(entity, vec3(1.0f, 2.0f, 3.0f));
+    store.destroy(entity);
+    CHECK(0 == store.size());
+}
+
+TEST(recycled_slot_gets_a_new_generation) {
+    EntityStore store;
+    Entity first = store.create();
+    store.destroy(first);
+    
+    Entity second = store.create();
+    CHECK(first.index == second.index);
+    CHECK(first.generation != second.generation);
+    CHECK(first != second);
+    CHECK(!store.alive(first));
+    CHECK(store.alive(second));
+    
+    store.setMesh(first, 7);
+    CHECK(no_mesh == store.getMeshes()[store.indexOf(second)]);
+}
+
+TEST(swap_remove_from_the_middle) {
+    EntityStore store;
+    EntityModels models;
+    vector<Entity> entities;
+    for(int i = 0; i < 5; i++) {
+        entities.push_back(add(store, models, (float)i, i));
+    }
+    store.update();
+    CHECK(consistent(store, models));
+    
+    store.destroy(entities[1]);
+    models.erase(key(entities[1]));
+    
+    CHECK(1 == store.indexOf(entities[4]));
+    CHECK(consistent(store, models));
+}
+
+TEST(swap_remove_from_the_end) {
+    EntityStore store;
+    EntityModels models;
+    vector<Entity> entities;
+    for(int i = 0; i < 4; i++) {
+        entities.push_back(add(store, models, (float)i, i));
+    }
+    store.update();
+    
+    store.destroy(entities[3]);
+    models.erase(key(entities[3]));
+    CHECK(consistent(store, models));
+    
+    for(int i = 0; i < 3; i++) {
+        CHECK(i == store.indexOf(entities[i]));
+    }
+}
+
+TEST(random_churn_stays_consistent) {
+    mt19937 random(11);
+    EntityStore store;
+    EntityModels models;
+    vector<Entity> live;
+    vector<Entity> dead;
+    
+    for(int step = 0; step < 5000; step++) {
+        if(live.empty() || random() % 3 != 0) {
+            live.push_back(add(store, models, (float)(step % 100), step));
+        }
+        else {
+            size_t pick = random() % live.size();
+            store.destroy(live[pick]);
+            models.erase(key(live[pick]));
+            dead.push_back(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+        
+        if(step % 500 == 0) {
+            store.update();
+            CHECK(consistent(store, models));
+        }
+    }
+    
+    store.update();
+    CHECK(consistent(store, models));
+    
+    bool none_alive = true;
+    for(const auto &entity: dead) {
+        none_alive = none_alive && !store.alive(entity) && -1 == store.indexOf(entity);
+    }
+    CHECK(none_alive);
+    
+    store.clear();
+    CHECK(0 == store.size());
+    for(const auto &entity: live) {
+        CHECK(!store.alive(entity));
+    }
+}
+
+int main(void) {
+    return run_tests();
+}
@@ -0,0 +1,158 @@
+//
+//  JobSystemTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "JobSystem.hpp"
+
+using namespace std;
+
+static bool each_index_once(JobSystem &jobs, size_t count, size_t grain) {
+    vector<atomic<int>> visits(count);
+    for(auto &visit: visits) {
+        visit = 0;
+    }
+    
+    jobs.parallelFor(count, grain, [&visits](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+    
+    for(auto &visit: visits) {
+        if(1 != visit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(parallel_for_runs_every_index_once) {
+    JobSystem jobs(3);
+    CHECK(3 == jobs.workerCount());
+    CHECK(each_index_once(jobs, 100003, 0));
+    CHECK(each_index_once(jobs, 100003, 7));
+    CHECK(each_index_once(jobs, 5, 64));
+    CHECK(each_index_once(jobs, 1, 0));
+    CHECK(each_index_once(jobs, 0, 0));
+}
+
+TEST(job_after_a_counter_waits_for_it) {
+    JobSystem jobs(3);
+    
+    for(int round = 0; round < 20; round++) {
+        JobCounter first;
+        JobCounter second;
+        atomic<int> finished(0);
+        atomic<bool> started_early(false);
+        
+        for(int i = 0; i < 4; i++) {
+            jobs.run([&finished] {
+                this_thread::sleep_for(chrono::milliseconds(2));
+                finished++;
+            }, &first);
+        }
+        for(int i = 0; i < 4; i++) {
+            jobs.run([&finished, &started_early] {
+                if(4 != finished) {
+                    started_early = true;
+                }
+            }, &second, &first);
+        }
+        
+        jobs.wait(second);
+        CHECK(!started_early);
+        CHECK(0 == first.get());
+        CHECK(0 == second.get());
+    }
+}
+
+/**
+ *  Every job waits on jobs of its own, with more of them
+ *  than there are threads, so this only finishes if a
+ *  waiting job runs other work rather than blocking.
+ */
+TEST(wait_inside_a_job_makes_progress) {
+    JobSystem jobs(1);
+    atomic<int> inner(0);
+    
+    jobs.parallelFor(16, 1, [&jobs, &inner](size_t, size_t) {
+        jobs.parallelFor(64, 4, [&inner](size_t begin, size_t end) {
+            inner += (int)(end - begin);
+        });
+    });
+    
+    CHECK(16 * 64 == inner);
+}
+
+TEST(no_workers_runs_jobs_in_wait_on_this_thread) {
+    JobSystem jobs(0);
+    CHECK(0 == jobs.workerCount());
+    
+    const thread::id caller = this_thread::get_id();
+    vector<int> order;
+    bool other_thread = false;
+    
+    JobCounter counter;
+    for(int i = 0; i < 4; i++) {
+        jobs.run([i, &order, &other_thread, caller] {
+            order.push_back(i);
+            other_thread = other_thread || caller != this_thread::get_id();
+        }, &counter);
+    }
+    CHECK(order.empty());
+    
+    jobs.wait(counter);
+    CHECK(4 == order.size());
+    CHECK(!other_thread);
+    
+    /**
+     *  Newest first from its own queue, every time.
+     */
+    vector<int> expected = {3, 2, 1, 0};
+    CHECK(expected == order);
+    
+    CHECK(each_index_once(jobs, 1000, 10));
+    
+    int nested = 0;
+    jobs.parallelFor(4, 1, [&jobs, &nested](size_t, size_t) {
+        jobs.parallelFor(8, 2, [&nested](size_t begin, size_t end) {
+            nested += (int)(end - begin);
+        });
+    });
+    CHECK(32 == nested);
+}
+
+TEST(no_workers_runs_jobs_after_their_counter) {
+    JobSystem jobs(0);
+    JobCounter first;
+    JobCounter second;
+    vector<int> order;
+    
+    jobs.run([&order] { order.push_back(1); }, &second, &first);
+    jobs.run([&order] { order.push_back(0); }, &first);
+    jobs.wait(second);
+    
+    vector<int> expected = {0, 1};
+    CHECK(expected == order);
+}
+
+#if defined(OPENGL_SINGLE_THREADED)
+TEST(single_threaded_build_has_no_workers) {
+    JobSystem jobs;
+    CHECK(0 == jobs.workerCount());
+    CHECK(each_index_once(jobs, 1000, 0));
+}
+#endif
+
+int main(void) {
+    return run_tests();
+}
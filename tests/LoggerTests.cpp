@@ -0,0 +1,211 @@
+//
+//  LoggerTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Check.hpp"
+#include "Logger.hpp"
+
+using namespace std;
+
+/**
+ *  A fresh directory for each test, so
+ *  files from one never turn up in another.
+ */
+static string log_directory(void) {
+    char name[] = "/tmp/logger_test_XXXXXX";
+    string directory = mkdtemp(name) ? name : "logger_test";
+    LogWriter::setDirectory(directory);
+    LogWriter::setMaxFileSize(0);
+    LogWriter::setLevel(log_level_debug);
+    return directory;
+}
+
+/**
+ *  Where LogWriter puts today's files, with ".1" and
+ *  so on on the end for the ones rotated out.
+ */
+static string log_path(const string &directory, const string &ext, int generation = 0) {
+    time_t t = time(nullptr);
+    tm local;
+    localtime_r(&t, &local);
+    
+    char date[16];
+    strftime(date, sizeof(date), "%d-%m-%Y", &local);
+    
+    string path = directory + "/" + date + ext;
+    if(generation > 0) {
+        path += "." + to_string(generation);
+    }
+    return path;
+}
+
+static vector<string> read_lines(const string &path) {
+    vector<string> lines;
+    ifstream file(path);
+    string line;
+    while(getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static bool exists(const string &path) {
+    struct stat info;
+    return 0 == stat(path.c_str(), &info);
+}
+
+static size_t file_size(const string &path) {
+    struct stat info;
+    return 0 == stat(path.c_str(), &info) ? (size_t)info.st_size : 0;
+}
+
+static void remove_logs(const string &directory) {
+    for(const char *ext: {".log", ".err"}) {
+        for(int generation = 0; generation <= 4; generation++) {
+            remove(log_path(directory, ext, generation).c_str());
+        }
+    }
+    rmdir(directory.c_str());
+}
+
+TEST(messages_are_written_in_order) {
+    string directory = log_directory();
+    
+    for(int i = 0; i < 1000; i++) {
+        Logger::log(log_level_info, "message %d", i);
+    }
+    LogWriter::flush();
+    
+    vector<string> lines = read_lines(log_path(directory, ".log"));
+    CHECK(1000 == lines.size());
+    
+    bool in_order = lines.size() == 1000;
+    for(size_t i = 0; in_order && i < lines.size(); i++) {
+        in_order = "INFO: message " + to_string(i) == lines[i];
+    }
+    CHECK(in_order);
+    CHECK(!exists(log_path(directory, ".err")));
+    remove_logs(directory);
+}
+
+TEST(warnings_and_errors_go_to_the_error_file) {
+    string directory = log_directory();
+    
+    Logger::log(log_level_debug, "debug");
+    Logger::log(log_level_info, "info");
+    Logger::log(log_level_warn, "warn");
+    Logger::log(log_level_error, "error %s", "text");
+    
+    Logger logger;
+    logger.write("written\n");
+    logger.write_err("written error\n");
+    LogWriter::flush();
+    
+    vector<string> expected_log = {"DEBUG: debug", "INFO: info", "written"};
+    vector<string> expected_err = {"WARN: warn", "ERROR: error text", "written error"};
+    CHECK(expected_log == read_lines(log_path(directory, ".log")));
+    CHECK(expected_err == read_lines(log_path(directory, ".err")));
+    remove_logs(directory);
+}
+
+TEST(messages_below_the_level_are_skipped) {
+    string directory = log_directory();
+    LogWriter::setLevel(log_level_warn);
+    
+    CHECK(!LogWriter::isEnabled(log_level_info));
+    CHECK(LogWriter::isEnabled(log_level_error));
+    LOG_INFO("skipped");
+    LOG_ERROR("kept");
+    LogWriter::flush();
+    
+    CHECK(!exists(log_path(directory, ".log")));
+    CHECK(1 == read_lines(log_path(directory, ".err")).size());
+    LogWriter::setLevel(log_level_debug);
+    remove_logs(directory);
+}
+
+TEST(full_files_are_rotated) {
+    string directory = log_directory();
+    LogWriter::setMaxFileSize(1024);
+    
+    /**
+     *  Flushing each time makes every batch its own write, so
+     *  the files are rotated at known points rather than
+     *  whenever the writer thread happens to wake.
+     */
+    string line(99, 'x');
+    for(int i = 0; i < 60; i++) {
+        Logger::log(log_level_info, "%s", line.c_str());
+        LogWriter::flush();
+    }
+    
+    const size_t line_size = strlen("INFO: ") + line.size() + 1;
+    CHECK(exists(log_path(directory, ".log", 1)));
+    CHECK(exists(log_path(directory, ".log", 2)));
+    CHECK(exists(log_path(directory, ".log", 3)));
+    CHECK(!exists(log_path(directory, ".log", 4)));
+    for(int generation = 1; generation <= 3; generation++) {
+        size_t size = file_size(log_path(directory, ".log", generation));
+        CHECK(size >= 1024 && size < 1024 + line_size);
+    }
+    CHECK(file_size(log_path(directory, ".log")) < 1024);
+    
+    LogWriter::setMaxFileSize(0);
+    remove_logs(directory);
+}
+
+/**
+ *  Whether anything is dropped depends on how fast the writer
+ *  keeps up, but every message is either written or counted,
+ *  and the count is reported in the error file.
+ */
+TEST(dropped_messages_are_counted) {
+    string directory = log_directory();
+    const size_t dropped_before = LogWriter::droppedCount();
+    
+    const int thread_count = 4;
+    const int per_thread = 20000;
+    vector<thread> threads;
+    for(int t = 0; t < thread_count; t++) {
+        threads.emplace_back([t] {
+            for(int i = 0; i < per_thread; i++) {
+                Logger::log(log_level_info, "thread %d message %d", t, i);
+            }
+        });
+    }
+    for(auto &t: threads) {
+        t.join();
+    }
+    LogWriter::flush();
+    
+    const size_t dropped = LogWriter::droppedCount() - dropped_before;
+    const size_t written = read_lines(log_path(directory, ".log")).size();
+    CHECK(thread_count * per_thread == written + dropped);
+    
+    if(dropped) {
+        size_t reported = 0;
+        for(const auto &line: read_lines(log_path(directory, ".err"))) {
+            reported += strtoul(line.c_str(), nullptr, 10);
+        }
+        CHECK(dropped == reported);
+    }
+    remove_logs(directory);
+}
+
+int main(void) {
+    return run_tests();
+}
@@ -0,0 +1,72 @@
+//
+//  ObjectLoaderTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <cstdio>
+#include <fstream>
+#include "Check.hpp"
+#include "ObjectLoader.hpp"
+
+using namespace std;
+
+#define test_object_path "object_loader_test.obj"
+
+static void write_object(const string &contents) {
+    ofstream file(test_object_path, ios::out | ios::trunc);
+    file << contents;
+}
+
+TEST(loads_vertices_in_order) {
+    write_object(
+        "# a triangle\n"
+        "v 1.0 2.0 3.0\n"
+        "v -1.5 0.25 4\n"
+        "vn 0.0 0.0 1.0\n"
+        "vt 0.5 0.5\n"
+        "v 0 0 -7.5\n"
+        "f 1 2 3\n"
+    );
+    
+    ObjectLoader loader;
+    loader.load(test_object_path);
+    vector<GLfloat> vertices = loader.getVertices();
+    
+    vector<GLfloat> expected = {1.0f, 2.0f, 3.0f, -1.5f, 0.25f, 4.0f, 0.0f, 0.0f, -7.5f};
+    CHECK(expected == vertices);
+    remove(test_object_path);
+}
+
+TEST(bad_vertex_stops_loading) {
+    write_object(
+        "v 1 2 3\n"
+        "v 4 5\n"
+        "v 6 7 8\n"
+    );
+    
+    ObjectLoader loader;
+    loader.load(test_object_path);
+    CHECK(3 == loader.getVertices().size());
+    remove(test_object_path);
+}
+
+TEST(missing_file_loads_nothing) {
+    ObjectLoader loader;
+    loader.load("no_such_file.obj");
+    CHECK(loader.getVertices().empty());
+}
+
+TEST(pushes_vertices) {
+    ObjectLoader loader;
+    loader.pushVertex({1.0f, 2.0f, 3.0f});
+    loader.pushVertex({4.0f, 5.0f, 6.0f});
+    CHECK(6 == loader.getVertices().size());
+    CHECK(6.0f == loader.getVertices()[5]);
+}
+
+int main(void) {
+    return run_tests();
+}
@@ -0,0 +1,102 @@
+//
+//  PerspectiveCameraTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Check.hpp"
+#include "PerspectiveCamera.hpp"
+
+using namespace std;
+
+static CameraInput held_keys(void) {
+    CameraInput input;
+    input.move = vec3(0.5f, 0.0f, -1.0f);
+    input.yaw = 1.0f;
+    input.pitch = 0.25f;
+    return input;
+}
+
+/**
+ *  Holds the same keys down every frame for one second,
+ *  with frame_times going round for as long as it takes.
+ */
+static PerspectiveCamera fly(const vector<double> &frame_times) {
+    PerspectiveCamera camera;
+    camera.setPosition(vec3(0.0f, 0.0f, 15.0f));
+    
+    double elapsed = 0.0;
+    for(size_t frame = 0; elapsed < 1.0; frame++) {
+        double dt = min(frame_times[frame % frame_times.size()], 1.0 - elapsed);
+        camera.input(held_keys());
+        camera.advance(dt);
+        elapsed += dt;
+    }
+    return camera;
+}
+
+static PerspectiveCamera fly_at(double fps) {
+    return fly(vector<double>(1, 1.0 / fps));
+}
+
+static void check_same_place(const PerspectiveCamera &a, const PerspectiveCamera &b) {
+    vec3 pa = a.position();
+    vec3 pb = b.position();
+    for(int i = 0; i < 3; i++) {
+        CHECK_NEAR(pa.v[i], pb.v[i], 1e-3);
+    }
+    for(int i = 0; i < 16; i++) {
+        CHECK_NEAR(a.view().m[i], b.view().m[i], 1e-3);
+    }
+}
+
+TEST(same_input_same_place_at_any_frame_rate) {
+    PerspectiveCamera at_37 = fly_at(37.0);
+    PerspectiveCamera at_60 = fly_at(60.0);
+    PerspectiveCamera at_240 = fly_at(240.0);
+    
+    check_same_place(at_37, at_60);
+    check_same_place(at_60, at_240);
+    
+    /**
+     *  And it did actually go somewhere.
+     */
+    vec3 moved = at_60.position();
+    float distance = sqrt(moved.v[0] * moved.v[0] + moved.v[1] * moved.v[1] + (moved.v[2] - 15.0f) * (moved.v[2] - 15.0f));
+    CHECK(distance > 5.0f);
+}
+
+TEST(uneven_frames_end_in_the_same_place) {
+    mt19937 random(3);
+    uniform_real_distribution<double> frame_time(1.0 / 240.0, 1.0 / 30.0);
+    
+    vector<double> frame_times(500);
+    for(auto &dt: frame_times) {
+        dt = frame_time(random);
+    }
+    
+    check_same_place(fly(frame_times), fly_at(60.0));
+}
+
+TEST(no_input_stays_put) {
+    PerspectiveCamera camera;
+    camera.setPosition(vec3(1.0f, 2.0f, 3.0f));
+    for(int frame = 0; frame < 60; frame++) {
+        camera.advance(1.0 / 60.0);
+    }
+    
+    vec3 position = camera.position();
+    CHECK_NEAR(position.v[0], 1.0f, 1e-6);
+    CHECK_NEAR(position.v[1], 2.0f, 1e-6);
+    CHECK_NEAR(position.v[2], 3.0f, 1e-6);
+}
+
+int main(void) {
+    return run_tests();
+}
@@ -0,0 +1,85 @@
+//
+//  QuaternionTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include "Check.hpp"
+#include "VecMat.hpp"
+
+using namespace std;
+
+static vec4 rotate(const versor &q, const vec3 &v) {
+    mat4 m = quat_to_mat4(q);
+    return m * vec4(v, 1.0f);
+}
+
+TEST(axis_angle_is_unit_length) {
+    versor q = quat_from_axis_deg(37.0f, 0.0f, 1.0f, 0.0f);
+    CHECK_NEAR(dot(q, q), 1.0f, 1e-6);
+}
+
+TEST(rotates_about_y) {
+    vec4 p = rotate(quat_from_axis_deg(90.0f, 0.0f, 1.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f));
+    CHECK_NEAR(p.v[0], 0.0f, 1e-6);
+    CHECK_NEAR(p.v[1], 0.0f, 1e-6);
+    CHECK_NEAR(p.v[2], -1.0f, 1e-6);
+}
+
+TEST(matches_rotation_matrices) {
+    mat4 q = quat_to_mat4(quat_from_axis_deg(30.0f, 0.0f, 0.0f, 1.0f));
+    mat4 r = rotate_z_deg(identity_mat4(), 30.0f);
+    for(int i = 0; i < 16; i++) {
+        CHECK_NEAR(q.m[i], r.m[i], 1e-6);
+    }
+}
+
+TEST(multiply_composes_rotations) {
+    versor a = quat_from_axis_deg(30.0f, 1.0f, 0.0f, 0.0f);
+    versor b = quat_from_axis_deg(50.0f, 0.0f, 1.0f, 0.0f);
+    
+    mat4 composed = quat_to_mat4(b * a);
+    mat4 multiplied = quat_to_mat4(b) * quat_to_mat4(a);
+    for(int i = 0; i < 16; i++) {
+        CHECK_NEAR(composed.m[i], multiplied.m[i], 1e-5);
+    }
+}
+
+TEST(slerp_end_points_and_middle) {
+    versor a = quat_from_axis_deg(0.0f, 0.0f, 1.0f, 0.0f);
+    versor b = quat_from_axis_deg(90.0f, 0.0f, 1.0f, 0.0f);
+    versor half = quat_from_axis_deg(45.0f, 0.0f, 1.0f, 0.0f);
+    
+    versor start = slerp(a, b, 0.0f);
+    versor end = slerp(a, b, 1.0f);
+    versor middle = slerp(a, b, 0.5f);
+    for(int i = 0; i < 4; i++) {
+        CHECK_NEAR(start.q[i], a.q[i], 1e-5);
+        CHECK_NEAR(end.q[i], b.q[i], 1e-5);
+        CHECK_NEAR(middle.q[i], half.q[i], 1e-5);
+    }
+}
+
+TEST(normalise_gives_unit_length) {
+    versor q = quat_from_axis_deg(60.0f, 0.0f, 0.0f, 1.0f) * 3.0f;
+    versor n = normalise(q);
+    CHECK_NEAR(dot(n, n), 1.0f, 1e-6);
+}
+
+TEST(compose_trs_matches_matrices) {
+    versor r = quat_from_axis_deg(40.0f, 0.0f, 1.0f, 0.0f);
+    mat4 trs = compose_trs(vec3(1.0f, 2.0f, 3.0f), r, vec3(2.0f, 2.0f, 2.0f));
+    
+    mat4 s = identity_mat4();
+    s.m[0] = s.m[5] = s.m[10] = 2.0f;
+    mat4 expected = translate(identity_mat4(), vec3(1.0f, 2.0f, 3.0f)) * quat_to_mat4(r) * s;
+    for(int i = 0; i < 16; i++) {
+        CHECK_NEAR(trs.m[i], expected.m[i], 1e-5);
+    }
+}
+
+int main(void) {
+    return run_tests();
+}
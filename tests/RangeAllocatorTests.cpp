@@ -0,0 +1,262 @@
+//
+//  RangeAllocatorTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <algorithm>
+#include <random>
+#include "Check.hpp"
+#include "RangeAllocator.hpp"
+
+using namespace std;
+
+/**
+ *  Checks no two allocated ranges overlap and all of
+ *  them fit, and that the stats add up.
+ */
+static bool consistent(const RangeAllocator &allocator, const vector<RangeHandle> &handles) {
+    vector<pair<size_t, size_t>> ranges;
+    size_t used = 0;
+    for(RangeHandle handle: handles) {
+        if(!allocator.valid(handle)) {
+            return false;
+        }
+        ranges.push_back({allocator.offset(handle), allocator.size(handle)});
+        used += allocator.size(handle);
+    }
+    sort(begin(ranges), end(ranges));
+    
+    RangeStats stats = allocator.stats();
+    for(size_t i = 0; i < ranges.size(); i++) {
+        if(ranges[i].first + ranges[i].second > stats.capacity) {
+            return false;
+        }
+        if(i > 0 && ranges[i - 1].first + ranges[i - 1].second > ranges[i].first) {
+            return false;
+        }
+    }
+    return stats.used == used && stats.allocations == handles.size() && stats.free == stats.capacity - used;
+}
+
+TEST(allocates_in_order_from_empty) {
+    RangeAllocator allocator(1000);
+    RangeHandle a = allocator.allocate(100);
+    RangeHandle b = allocator.allocate(200);
+    
+    CHECK(no_range != a && no_range != b);
+    CHECK(0 == allocator.offset(a));
+    CHECK(100 == allocator.size(a));
+    CHECK(100 == allocator.offset(b));
+    CHECK(200 == allocator.size(b));
+    CHECK(consistent(allocator, {a, b}));
+}
+
+TEST(exhaustion_returns_no_range) {
+    RangeAllocator allocator(100);
+    CHECK(no_range == allocator.allocate(101));
+    
+    RangeHandle a = allocator.allocate(100);
+    CHECK(no_range != a);
+    CHECK(no_range == allocator.allocate(1));
+    
+    allocator.free(a);
+    CHECK(no_range != allocator.allocate(100));
+    
+    RangeAllocator empty;
+    CHECK(no_range == empty.allocate(1));
+}
+
+TEST(free_coalesces_with_both_neighbours) {
+    RangeAllocator allocator(300);
+    RangeHandle a = allocator.allocate(100);
+    RangeHandle b = allocator.allocate(100);
+    RangeHandle c = allocator.allocate(100);
+    
+    allocator.free(a);
+    allocator.free(c);
+    RangeStats split = allocator.stats();
+    CHECK(2 == split.free_blocks);
+    CHECK(100 == split.largest_free);
+    CHECK(split.fragmentation > 0.0f);
+    
+    allocator.free(b);
+    RangeStats merged = allocator.stats();
+    CHECK(1 == merged.free_blocks);
+    CHECK(300 == merged.largest_free);
+    CHECK(0.0f == merged.fragmentation);
+    CHECK(0 == merged.allocations);
+    CHECK(no_range != allocator.allocate(300));
+}
+
+TEST(free_coalesces_with_next) {
+    RangeAllocator allocator(300);
+    RangeHandle a = allocator.allocate(100);
+    RangeHandle b = allocator.allocate(100);
+    
+    allocator.free(b);
+    CHECK(1 == allocator.stats().free_blocks);
+    CHECK(200 == allocator.stats().largest_free);
+    
+    allocator.free(a);
+    CHECK(300 == allocator.stats().largest_free);
+}
+
+TEST(free_coalesces_with_previous) {
+    RangeAllocator allocator(300);
+    RangeHandle a = allocator.allocate(100);
+    RangeHandle b = allocator.allocate(100);
+    RangeHandle c = allocator.allocate(100);
+    
+    allocator.free(a);
+    allocator.free(b);
+    RangeStats stats = allocator.stats();
+    CHECK(1 == stats.free_blocks);
+    CHECK(200 == stats.largest_free);
+    CHECK(consistent(allocator, {c}));
+}
+
+TEST(stale_handles_are_rejected) {
+    RangeAllocator allocator(100);
+    RangeHandle a = allocator.allocate(100);
+    allocator.free(a);
+    CHECK(!allocator.valid(a));
+    
+    RangeHandle b = allocator.allocate(100);
+    CHECK(allocator.valid(b));
+    CHECK(a != b);
+    
+    allocator.free(a);
+    CHECK(allocator.valid(b));
+    CHECK(1 == allocator.stats().allocations);
+    CHECK(0 == allocator.size(a));
+    
+    allocator.free(no_range);
+    CHECK(!allocator.valid(no_range));
+    CHECK(1 == allocator.stats().allocations);
+}
+
+TEST(grow_extends_free_space_at_the_end) {
+    RangeAllocator allocator(100);
+    RangeHandle a = allocator.allocate(60);
+    CHECK(no_range == allocator.allocate(60));
+    
+    allocator.grow(200);
+    CHECK(200 == allocator.stats().capacity);
+    CHECK(1 == allocator.stats().free_blocks);
+    
+    RangeHandle b = allocator.allocate(140);
+    CHECK(no_range != b);
+    CHECK(60 == allocator.offset(b));
+    CHECK(consistent(allocator, {a, b}));
+    
+    allocator.grow(300);
+    RangeHandle c = allocator.allocate(100);
+    CHECK(200 == allocator.offset(c));
+    
+    allocator.grow(100);
+    CHECK(300 == allocator.stats().capacity);
+}
+
+TEST(grow_from_empty) {
+    RangeAllocator allocator;
+    allocator.grow(50);
+    RangeHandle a = allocator.allocate(50);
+    CHECK(no_range != a);
+    CHECK(0 == allocator.offset(a));
+}
+
+TEST(defragment_packs_ranges_and_lists_moves) {
+    RangeAllocator allocator(500);
+    RangeHandle a = allocator.allocate(100);
+    RangeHandle b = allocator.allocate(100);
+    RangeHandle c = allocator.allocate(100);
+    RangeHandle d = allocator.allocate(100);
+    
+    allocator.free(a);
+    allocator.free(c);
+    CHECK(no_range == allocator.allocate(150));
+    
+    vector<RangeMove> moves = allocator.defragment();
+    CHECK(2 == moves.size());
+    if(2 == moves.size()) {
+        CHECK(b == moves[0].handle);
+        CHECK(100 == moves[0].from && 0 == moves[0].to && 100 == moves[0].size);
+        CHECK(d == moves[1].handle);
+        CHECK(300 == moves[1].from && 100 == moves[1].to && 100 == moves[1].size);
+    }
+    
+    CHECK(0 == allocator.offset(b));
+    CHECK(100 == allocator.offset(d));
+    RangeStats stats = allocator.stats();
+    CHECK(1 == stats.free_blocks);
+    CHECK(300 == stats.largest_free);
+    CHECK(0.0f == stats.fragmentation);
+    
+    RangeHandle e = allocator.allocate(300);
+    CHECK(200 == allocator.offset(e));
+    CHECK(consistent(allocator, {b, d, e}));
+    
+    CHECK(allocator.defragment().empty());
+}
+
+TEST(stats_count_everything) {
+    RangeAllocator allocator(1000);
+    RangeStats empty = allocator.stats();
+    CHECK(1000 == empty.capacity);
+    CHECK(0 == empty.used);
+    CHECK(1000 == empty.free);
+    CHECK(1000 == empty.largest_free);
+    CHECK(0 == empty.allocations);
+    CHECK(1 == empty.free_blocks);
+    
+    RangeHandle a = allocator.allocate(250);
+    allocator.allocate(250);
+    allocator.free(a);
+    
+    RangeStats stats = allocator.stats();
+    CHECK(250 == stats.used);
+    CHECK(750 == stats.free);
+    CHECK(500 == stats.largest_free);
+    CHECK(1 == stats.allocations);
+    CHECK(2 == stats.free_blocks);
+    CHECK_NEAR(stats.fragmentation, 1.0f - 500.0f / 750.0f, 1e-6);
+}
+
+TEST(random_allocations_stay_consistent) {
+    mt19937 random(1);
+    uniform_int_distribution<size_t> size(1, 300);
+    RangeAllocator allocator(20000);
+    vector<RangeHandle> live;
+    
+    for(int i = 0; i < 5000; i++) {
+        if(!live.empty() && random() % 3 == 0) {
+            size_t which = random() % live.size();
+            allocator.free(live[which]);
+            live.erase(begin(live) + which);
+        }
+        else {
+            RangeHandle handle = allocator.allocate(size(random));
+            if(no_range != handle) {
+                live.push_back(handle);
+            }
+        }
+        
+        if(i % 500 == 0) {
+            allocator.defragment();
+        }
+    }
+    
+    CHECK(consistent(allocator, live));
+    for(RangeHandle handle: live) {
+        allocator.free(handle);
+    }
+    CHECK(1 == allocator.stats().free_blocks);
+    CHECK(0 == allocator.stats().used);
+}
+
+int main(void) {
+    return run_tests();
+}
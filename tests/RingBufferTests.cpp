@@ -0,0 +1,78 @@
+//
+//  RingBufferTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "RingBuffer.hpp"
+
+using namespace std;
+
+TEST(heap_rings_are_aligned) {
+    for(int i = 0; i < 16; i++) {
+        unique_ptr<RingBuffer<int>> ring(new RingBuffer<int>(8));
+        CHECK(0 == (uintptr_t)ring.get() % alignof(RingBuffer<int>));
+    }
+}
+
+TEST(size_counts_what_is_waiting) {
+    RingBuffer<int> ring(8);
+    CHECK(8 == ring.capacity());
+    CHECK(0 == ring.size());
+    
+    for(int i = 0; i < 8; i++) {
+        CHECK(ring.push(i));
+    }
+    CHECK(!ring.push(8));
+    CHECK(8 == ring.size());
+    
+    int values[8];
+    CHECK(3 == ring.pop(values, 3));
+    CHECK(0 == values[0] && 2 == values[2]);
+    CHECK(5 == ring.size());
+    
+    CHECK(5 == ring.pop(values, 8));
+    CHECK(3 == values[0] && 7 == values[4]);
+    CHECK(0 == ring.size());
+}
+
+TEST(pops_in_order_across_threads) {
+    RingBuffer<int> ring(64);
+    const int count = 100000;
+    
+    thread pusher([&ring]() {
+        for(int i = 0; i < count; i++) {
+            while(!ring.push(i)) {
+                this_thread::yield();
+            }
+        }
+    });
+    
+    vector<int> values(64);
+    int expected = 0;
+    bool in_order = true;
+    while(expected < count) {
+        size_t popped = ring.pop(&values[0], ring.size());
+        if(0 == popped) {
+            this_thread::yield();
+        }
+        for(size_t i = 0; i < popped; i++) {
+            in_order = in_order && expected++ == values[i];
+        }
+    }
+    pusher.join();
+    
+    CHECK(in_order);
+    CHECK(0 == ring.size());
+}
+
+int main(void) {
+    return run_tests();
+}
@@ -0,0 +1,214 @@
+//
+//  SceneGraphTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <algorithm>
+#include <random>
+#include "Check.hpp"
+#include "SceneGraph.hpp"
+
+using namespace std;
+
+static bool mat4_near(const mat4 &a, const mat4 &b, float tolerance) {
+    for(int i = 0; i < 16; i++) {
+        if(fabs(a.m[i] - b.m[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static mat4 local_matrix(const SceneGraph &graph, SceneNode node) {
+    const Transform &t = graph.local(node);
+    return compose_trs(t.position, t.rotation, t.scale);
+}
+
+/**
+ *  Parent times local all the way up, worked out by hand
+ *  rather than trusting anything the graph has stored.
+ */
+static mat4 expected_world(const SceneGraph &graph, SceneNode node) {
+    mat4 world = local_matrix(graph, node);
+    for(SceneNode p = graph.parent(node); no_scene_node != p; p = graph.parent(p)) {
+        world = local_matrix(graph, p) * world;
+    }
+    return world;
+}
+
+static bool all_worlds_match(const SceneGraph &graph) {
+    for(SceneNode node = 0; node < (SceneNode)graph.size(); node++) {
+        if(!mat4_near(graph.world(node), expected_world(graph, node), 1e-4f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void place(SceneGraph &graph, SceneNode node, float x, float y, float z, float degrees) {
+    graph.setPosition(node, vec3(x, y, z));
+    graph.setRotation(node, quat_from_euler_deg(degrees, degrees * 0.5f, -degrees));
+}
+
+static bool changed_contains(const SceneGraph &graph, SceneNode node) {
+    const vector<SceneNode> &changed = graph.changed();
+    return changed.end() != find(changed.begin(), changed.end(), node);
+}
+
+TEST(worlds_compose_parent_and_local) {
+    SceneGraph graph;
+    SceneNode root = graph.create();
+    SceneNode arm = graph.create(root);
+    SceneNode hand = graph.create(arm);
+    
+    place(graph, root, 1.0f, 2.0f, 3.0f, 30.0f);
+    place(graph, arm, 0.0f, 4.0f, 0.0f, 45.0f);
+    place(graph, hand, 0.5f, 0.0f, -1.0f, 10.0f);
+    graph.setScale(arm, vec3(2.0f, 2.0f, 2.0f));
+    graph.update();
+    
+    mat4 hand_world = local_matrix(graph, root) * local_matrix(graph, arm) * local_matrix(graph, hand);
+    CHECK(mat4_near(graph.world(hand), hand_world, 1e-4f));
+    CHECK(all_worlds_match(graph));
+    CHECK(3 == graph.changed().size());
+}
+
+/**
+ *  Moving a node under a parent made after it puts it out of
+ *  breadth first order, which update has to lay out again.
+ */
+TEST(reparent_moves_the_subtree) {
+    SceneGraph graph;
+    SceneNode first = graph.create();
+    SceneNode child = graph.create(first);
+    SceneNode grandchild = graph.create(child);
+    SceneNode second = graph.create();
+    SceneNode other = graph.create(second);
+    
+    place(graph, first, -5.0f, 0.0f, 0.0f, 20.0f);
+    place(graph, child, 0.0f, 1.0f, 0.0f, 40.0f);
+    place(graph, grandchild, 0.0f, 0.0f, 2.0f, 60.0f);
+    place(graph, second, 5.0f, 0.0f, 0.0f, -30.0f);
+    place(graph, other, 1.0f, 1.0f, 1.0f, 90.0f);
+    graph.update();
+    
+    CHECK(graph.setParent(child, other));
+    CHECK(other == graph.parent(child));
+    graph.update();
+    
+    mat4 grandchild_world = local_matrix(graph, second) * local_matrix(graph, other) *
+                            local_matrix(graph, child) * local_matrix(graph, grandchild);
+    CHECK(mat4_near(graph.world(grandchild), grandchild_world, 1e-4f));
+    CHECK(all_worlds_match(graph));
+    CHECK(changed_contains(graph, child));
+    CHECK(changed_contains(graph, grandchild));
+    CHECK(!changed_contains(graph, first));
+    CHECK(!changed_contains(graph, second));
+    
+    CHECK(graph.setParent(child, no_scene_node));
+    graph.update();
+    CHECK(mat4_near(graph.world(child), local_matrix(graph, child), 1e-5f));
+    CHECK(all_worlds_match(graph));
+}
+
+TEST(reparent_under_own_child_is_refused) {
+    SceneGraph graph;
+    SceneNode root = graph.create();
+    SceneNode child = graph.create(root);
+    SceneNode grandchild = graph.create(child);
+    
+    CHECK(!graph.setParent(root, grandchild));
+    CHECK(!graph.setParent(child, child));
+    CHECK(no_scene_node == graph.parent(root));
+    CHECK(child == graph.parent(grandchild));
+}
+
+TEST(touching_a_leaf_only_changes_the_leaf) {
+    SceneGraph graph;
+    SceneNode root = graph.create();
+    SceneNode left = graph.create(root);
+    SceneNode right = graph.create(root);
+    SceneNode left_leaf = graph.create(left);
+    SceneNode right_leaf = graph.create(right);
+    
+    place(graph, root, 0.0f, 0.0f, -10.0f, 15.0f);
+    place(graph, left, -2.0f, 0.0f, 0.0f, 25.0f);
+    place(graph, right, 2.0f, 0.0f, 0.0f, 35.0f);
+    place(graph, left_leaf, 0.0f, 1.0f, 0.0f, 45.0f);
+    place(graph, right_leaf, 0.0f, -1.0f, 0.0f, 55.0f);
+    graph.update();
+    
+    mat4 left_world = graph.world(left);
+    mat4 right_leaf_world = graph.world(right_leaf);
+    
+    place(graph, left_leaf, 3.0f, 3.0f, 3.0f, 70.0f);
+    graph.update();
+    
+    CHECK(1 == graph.changed().size());
+    CHECK(changed_contains(graph, left_leaf));
+    CHECK(mat4_near(graph.world(left_leaf), local_matrix(graph, root) * local_matrix(graph, left) * local_matrix(graph, left_leaf), 1e-4f));
+    CHECK(mat4_near(graph.world(left), left_world, 0.0f));
+    CHECK(mat4_near(graph.world(right_leaf), right_leaf_world, 0.0f));
+    
+    graph.update();
+    CHECK(graph.changed().empty());
+}
+
+TEST(touching_a_parent_changes_its_subtree) {
+    SceneGraph graph;
+    SceneNode root = graph.create();
+    SceneNode left = graph.create(root);
+    SceneNode right = graph.create(root);
+    SceneNode left_leaf = graph.create(left);
+    graph.update();
+    
+    place(graph, left, 1.0f, 0.0f, 0.0f, 10.0f);
+    graph.update();
+    
+    CHECK(2 == graph.changed().size());
+    CHECK(changed_contains(graph, left));
+    CHECK(changed_contains(graph, left_leaf));
+    CHECK(!changed_contains(graph, right));
+    CHECK(all_worlds_match(graph));
+}
+
+TEST(job_update_matches_serial_update) {
+    mt19937 random(7);
+    uniform_real_distribution<float> offset(-5.0f, 5.0f);
+    uniform_real_distribution<float> angle(-180.0f, 180.0f);
+    
+    SceneGraph serial;
+    SceneGraph parallel;
+    for(int i = 0; i < 2000; i++) {
+        SceneNode parent = i < 8 ? no_scene_node : (SceneNode)(random() % i);
+        serial.create(parent);
+        parallel.create(parent);
+    }
+    
+    JobSystem jobs(3);
+    for(int round = 0; round < 3; round++) {
+        for(int touch = 0; touch < 200; touch++) {
+            SceneNode node = (SceneNode)(random() % serial.size());
+            float x = offset(random), y = offset(random), z = offset(random), degrees = angle(random);
+            place(serial, node, x, y, z, degrees);
+            place(parallel, node, x, y, z, degrees);
+        }
+        serial.update();
+        parallel.update(jobs);
+        
+        bool same = true;
+        for(SceneNode node = 0; node < (SceneNode)serial.size(); node++) {
+            same = same && mat4_near(serial.world(node), parallel.world(node), 0.0f);
+        }
+        CHECK(same);
+        CHECK(serial.changed().size() == parallel.changed().size());
+    }
+    CHECK(all_worlds_match(serial));
+}
+
+int main(void) {
+    return run_tests();
+}
@@ -0,0 +1,142 @@
+//
+//  ShaderPreprocessorTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include "Check.hpp"
+#include "ShaderPreprocessor.hpp"
+
+using namespace std;
+
+#define test_shader_path "shader_preprocessor_test.glsl"
+
+static void write_shader(const string &path, const string &contents) {
+    ofstream file(path, ios::out | ios::trunc);
+    file << contents;
+}
+
+/**
+ *  Where a line starts in source, or npos if it isn't there.
+ */
+static size_t line_at(const string &source, const string &line) {
+    if(0 == source.compare(0, line.size() + 1, line + "\n")) {
+        return 0;
+    }
+    size_t at = source.find("\n" + line + "\n");
+    return string::npos == at ? at : at + 1;
+}
+
+TEST(defines_go_after_version) {
+    ShaderPreprocessor::clear();
+    write_shader(test_shader_path,
+        "#version 410\n"
+        "#ifdef FOG\n"
+        "#endif\n"
+    );
+    
+    string source = ShaderPreprocessor::load(test_shader_path, {"FOG"});
+    CHECK(0 == line_at(source, "#version 410"));
+    CHECK(line_at(source, "#version 410") < line_at(source, "#define FOG"));
+    CHECK(string::npos != line_at(source, "#line 2 0"));
+    remove(test_shader_path);
+}
+
+TEST(defines_go_after_version_past_leading_comments) {
+    ShaderPreprocessor::clear();
+    write_shader(test_shader_path,
+        "// mesh.vert\n"
+        "\n"
+        "/*\n"
+        " *  #version 100 in a comment doesn't count.\n"
+        " */\n"
+        "   \n"
+        "#version 410\n"
+        "#ifdef FOG\n"
+        "#endif\n"
+    );
+    
+    string source = ShaderPreprocessor::load(test_shader_path, {"FOG"});
+    size_t version = line_at(source, "#version 410");
+    size_t define = line_at(source, "#define FOG");
+    CHECK(string::npos != version);
+    CHECK(string::npos != define);
+    CHECK(version < define);
+    CHECK(define < line_at(source, "#ifdef FOG"));
+    CHECK(string::npos != line_at(source, "#line 8 0"));
+    remove(test_shader_path);
+}
+
+TEST(defines_go_first_without_version) {
+    ShaderPreprocessor::clear();
+    write_shader(test_shader_path,
+        "// no version\n"
+        "#ifdef FOG\n"
+        "#endif\n"
+    );
+    
+    string source = ShaderPreprocessor::load(test_shader_path, {"FOG"});
+    CHECK(0 == line_at(source, "#define FOG"));
+    CHECK(string::npos != line_at(source, "#line 1 0"));
+    remove(test_shader_path);
+}
+
+TEST(unused_defines_share_a_variant) {
+    ShaderPreprocessor::clear();
+    write_shader(test_shader_path,
+        "#version 410\n"
+        "#ifdef FOG\n"
+        "#endif\n"
+    );
+    
+    string plain = ShaderPreprocessor::load(test_shader_path);
+    CHECK(plain == ShaderPreprocessor::load(test_shader_path, {"SHADOWS"}));
+    CHECK(plain != ShaderPreprocessor::load(test_shader_path, {"FOG"}));
+    CHECK(2 == ShaderPreprocessor::variantCount());
+    remove(test_shader_path);
+}
+
+TEST(dependencies_list_the_file_and_its_includes) {
+    ShaderPreprocessor::clear();
+    write_shader("shader_preprocessor_common.glsl", "float common_value;\n");
+    write_shader(test_shader_path,
+        "#version 410\n"
+        "#include \"shader_preprocessor_common.glsl\"\n"
+    );
+    
+    vector<string> files = ShaderPreprocessor::dependencies(test_shader_path);
+    CHECK(2 == files.size());
+    CHECK(files.end() != find(files.begin(), files.end(), test_shader_path));
+    CHECK(files.end() != find(files.begin(), files.end(), "shader_preprocessor_common.glsl"));
+    remove("shader_preprocessor_common.glsl");
+    remove(test_shader_path);
+}
+
+TEST(missing_file_is_still_a_dependency) {
+    ShaderPreprocessor::clear();
+    remove(test_shader_path);
+    
+    vector<string> files = ShaderPreprocessor::dependencies(test_shader_path);
+    CHECK(1 == files.size());
+    CHECK(files.end() != find(files.begin(), files.end(), test_shader_path));
+}
+
+TEST(failed_loads_are_not_kept) {
+    ShaderPreprocessor::clear();
+    remove(test_shader_path);
+    CHECK(ShaderPreprocessor::load(test_shader_path).empty());
+    CHECK(0 == ShaderPreprocessor::variantCount());
+    
+    write_shader(test_shader_path, "#version 410\n");
+    CHECK(0 == line_at(ShaderPreprocessor::load(test_shader_path), "#version 410"));
+    remove(test_shader_path);
+}
+
+int main(void) {
+    return run_tests();
+}
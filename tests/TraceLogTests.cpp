@@ -0,0 +1,183 @@
+//
+//  TraceLogTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "TraceLog.hpp"
+
+using namespace std;
+
+#define test_trace_path "trace_log_test.trace"
+#define test_bad_trace_path "trace_log_test_bad.trace"
+
+/**
+ *  The decoded lines without the time and thread in
+ *  front, which is "[    0.000123] [0] ".
+ */
+static vector<string> decoded_text(const string &path, vector<int> *threads = nullptr) {
+    stringstream out;
+    CHECK(TraceLog::decode(path, out));
+    
+    vector<string> lines;
+    string line;
+    while(getline(out, line)) {
+        size_t thread_start = line.find("] [");
+        size_t text_start = line.find("] ", thread_start + 3);
+        if(string::npos == thread_start || string::npos == text_start) {
+            lines.push_back("<bad line> " + line);
+            continue;
+        }
+        if(threads) {
+            threads->push_back(atoi(line.c_str() + thread_start + 3));
+        }
+        lines.push_back(line.substr(text_start + 2));
+    }
+    return lines;
+}
+
+static string read_bytes(const string &path) {
+    ifstream file(path, ios::in | ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+static void write_bytes(const string &path, const string &bytes) {
+    ofstream file(path, ios::out | ios::binary | ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+TEST(traces_round_trip_through_decode) {
+    int local = 0;
+    const void *pointer = &local;
+    char pointer_text[32];
+    snprintf(pointer_text, sizeof(pointer_text), "%p", pointer);
+    
+    CHECK(TraceLog::start(test_trace_path));
+    TRACE("no arguments");
+    TRACE("ints: %d %u %ld %zu", -42, 7u, -1234567890123L, (size_t)99);
+    TRACE("hex %x, padded [%5d] [%-4d]", 255, 12, 3);
+    TRACE("floats: %.2f %.3e %g", 3.14159f, 12345.678, -0.5);
+    TRACE("float as int %d, int as float %.1f", 2.75, 4);
+    TRACE("pointer %p", pointer);
+    TRACE("100%% done, char %c", 'A');
+    TRACE("a format long enough that it takes more than one record's worth of padding to hold it: %d", 1);
+    TraceLog::stop();
+    
+    vector<string> expected = {
+        "no arguments",
+        "ints: -42 7 -1234567890123 99",
+        "hex ff, padded [   12] [3   ]",
+        "floats: 3.14 1.235e+04 -0.5",
+        "float as int 2, int as float 4.0",
+        string("pointer ") + pointer_text,
+        "100% done, char A",
+        "a format long enough that it takes more than one record's worth of padding to hold it: 1"
+    };
+    vector<string> lines = decoded_text(test_trace_path);
+    CHECK(expected == lines);
+    for(size_t i = 0; i < lines.size() && i < expected.size(); i++) {
+        if(expected[i] != lines[i]) {
+            printf("    expected \"%s\" got \"%s\"\n", expected[i].c_str(), lines[i].c_str());
+        }
+    }
+    remove(test_trace_path);
+}
+
+TEST(each_thread_traces_under_its_own_index) {
+    CHECK(TraceLog::start(test_trace_path));
+    TRACE("main %d", 1);
+    thread other([] {
+        TRACE("other %d", 2);
+    });
+    other.join();
+    TRACE("main %d", 3);
+    TraceLog::stop();
+    
+    vector<int> threads;
+    vector<string> lines = decoded_text(test_trace_path, &threads);
+    CHECK(3 == lines.size());
+    
+    int main_thread = -1;
+    int other_thread = -1;
+    for(size_t i = 0; i < lines.size(); i++) {
+        if(0 == lines[i].compare(0, 5, "other")) {
+            other_thread = threads[i];
+        }
+        else {
+            main_thread = threads[i];
+        }
+    }
+    CHECK(-1 != main_thread && -1 != other_thread);
+    CHECK(main_thread != other_thread);
+    remove(test_trace_path);
+}
+
+TEST(traces_before_start_are_not_written) {
+    TRACE("before start %d", 1);
+    CHECK(!TraceLog::isEnabled());
+    
+    CHECK(TraceLog::start(test_trace_path));
+    TRACE("after start %d", 2);
+    TraceLog::stop();
+    TRACE("after stop %d", 3);
+    
+    vector<string> expected = {"after start 2"};
+    CHECK(expected == decoded_text(test_trace_path));
+    remove(test_trace_path);
+}
+
+/**
+ *  The header is magic, version, record size
+ *  and a reserved word, 32 bits each.
+ */
+TEST(decode_turns_down_other_files) {
+    CHECK(TraceLog::start(test_trace_path));
+    TRACE("something %d", 1);
+    TraceLog::stop();
+    
+    const string good = read_bytes(test_trace_path);
+    CHECK(good.size() > 16);
+    stringstream out;
+    
+    string bad_magic = good;
+    bad_magic[0] ^= 0xff;
+    write_bytes(test_bad_trace_path, bad_magic);
+    CHECK(!TraceLog::decode(test_bad_trace_path, out));
+    
+    string bad_version = good;
+    uint32_t version = 2;
+    memcpy(&bad_version[4], &version, sizeof(version));
+    write_bytes(test_bad_trace_path, bad_version);
+    CHECK(!TraceLog::decode(test_bad_trace_path, out));
+    
+    string bad_record_size = good;
+    uint32_t record_size = sizeof(TraceRecord) / 2;
+    memcpy(&bad_record_size[8], &record_size, sizeof(record_size));
+    write_bytes(test_bad_trace_path, bad_record_size);
+    CHECK(!TraceLog::decode(test_bad_trace_path, out));
+    
+    write_bytes(test_bad_trace_path, good.substr(0, 8));
+    CHECK(!TraceLog::decode(test_bad_trace_path, out));
+    
+    CHECK(!TraceLog::decode("no_such_file.trace", out));
+    CHECK(out.str().empty());
+    
+    remove(test_bad_trace_path);
+    remove(test_trace_path);
+}
+
+int main(void) {
+    return run_tests();
+}
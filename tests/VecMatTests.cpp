@@ -0,0 +1,143 @@
+//
+//  VecMatTests.cpp
+//  OpenGL
+//
+//  Created by Matt Finucane on 08/04/2017.
+//  Copyright © 2017 Matt Finucane. All rights reserved.
+//
+
+#include <random>
+#include "Check.hpp"
+#include "VecMat.hpp"
+
+using namespace std;
+
+static bool mat4_near(const mat4 &a, const mat4 &b, float tolerance) {
+    for(int i = 0; i < 16; i++) {
+        if(fabs(a.m[i] - b.m[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static mat4 sample_matrix(void) {
+    return mat4(
+        2.0f, 0.5f, 0.0f, 0.0f,
+        -1.0f, 3.0f, 0.25f, 0.0f,
+        0.0f, 1.0f, 4.0f, 0.0f,
+        5.0f, -2.0f, 1.0f, 1.0f
+    );
+}
+
+TEST(identity_is_neutral) {
+    mat4 m = sample_matrix();
+    mat4 i = identity_mat4();
+    CHECK(mat4_near(m * i, m, 0.0f));
+    CHECK(mat4_near(i * m, m, 0.0f));
+}
+
+TEST(matrices_are_column_major) {
+    mat4 t = translate(identity_mat4(), vec3(1.0f, 2.0f, 3.0f));
+    CHECK(1.0f == t.m[12]);
+    CHECK(2.0f == t.m[13]);
+    CHECK(3.0f == t.m[14]);
+    
+    vec4 p = t * vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    CHECK_NEAR(p.v[0], 2.0f, 0.0);
+    CHECK_NEAR(p.v[1], 3.0f, 0.0);
+    CHECK_NEAR(p.v[2], 4.0f, 0.0);
+    CHECK_NEAR(p.v[3], 1.0f, 0.0);
+}
+
+TEST(multiply_applies_right_first) {
+    mat4 t = translate(identity_mat4(), vec3(10.0f, 0.0f, 0.0f));
+    mat4 r = rotate_z_deg(identity_mat4(), 90.0f);
+    
+    vec4 p = (t * r) * vec4(1.0f, 0.0f, 0.0f, 1.0f);
+    CHECK_NEAR(p.v[0], 10.0f, 1e-5);
+    CHECK_NEAR(p.v[1], 1.0f, 1e-5);
+}
+
+TEST(inverse_undoes_matrix) {
+    mat4 m = sample_matrix();
+    CHECK(mat4_near(m * inverse(m), identity_mat4(), 1e-5f));
+    CHECK(mat4_near(inverse(m) * m, identity_mat4(), 1e-5f));
+}
+
+TEST(transpose_swaps_rows_and_columns) {
+    mat4 m = sample_matrix();
+    mat4 t = transpose(m);
+    for(int col = 0; col < 4; col++) {
+        for(int row = 0; row < 4; row++) {
+            CHECK(m.m[col * 4 + row] == t.m[row * 4 + col]);
+        }
+    }
+    CHECK(mat4_near(transpose(t), m, 0.0f));
+}
+
+TEST(determinant_of_scale) {
+    mat4 m = identity_mat4();
+    m.m[0] = 2.0f;
+    m.m[5] = 3.0f;
+    m.m[10] = 4.0f;
+    CHECK_NEAR(determinant(m), 24.0f, 1e-5);
+    CHECK_NEAR(determinant(identity_mat4()), 1.0f, 0.0);
+}
+
+TEST(perspective_maps_near_and_far) {
+    const float near = 0.1f;
+    const float far = 100.0f;
+    mat4 p = perspective(67.0f, 1.5f, near, far);
+    
+    vec4 n = p * vec4(0.0f, 0.0f, -near, 1.0f);
+    vec4 f = p * vec4(0.0f, 0.0f, -far, 1.0f);
+    CHECK_NEAR(n.v[2] / n.v[3], -1.0f, 1e-4);
+    CHECK_NEAR(f.v[2] / f.v[3], 1.0f, 1e-4);
+}
+
+TEST(perspective_reverse_z_maps_near_and_far) {
+    const float near = 0.1f;
+    const float far = 100.0f;
+    mat4 p = perspective_reverse_z(67.0f, 1.5f, near, far);
+    
+    vec4 n = p * vec4(0.0f, 0.0f, -near, 1.0f);
+    vec4 f = p * vec4(0.0f, 0.0f, -far, 1.0f);
+    CHECK_NEAR(n.v[2] / n.v[3], 1.0f, 1e-5);
+    CHECK_NEAR(f.v[2] / f.v[3], 0.0f, 1e-5);
+    
+    mat4 infinite = perspective_reverse_z(67.0f, 1.5f, near);
+    vec4 distant = infinite * vec4(0.0f, 0.0f, -1e6f, 1.0f);
+    CHECK(distant.v[2] / distant.v[3] > 0.0f);
+}
+
+TEST(rigid_inverse_matches_inverse) {
+    mt19937 random(1);
+    uniform_real_distribution<float> angle(-180.0f, 180.0f);
+    uniform_real_distribution<float> axis(-1.0f, 1.0f);
+    uniform_real_distribution<float> position(-100.0f, 100.0f);
+    
+    for(int i = 0; i < 1000; i++) {
+        vec3 a = normalise(vec3(axis(random), axis(random), axis(random)));
+        versor r = quat_from_axis_deg(angle(random), a.v[0], a.v[1], a.v[2]);
+        mat4 m = compose_trs(vec3(position(random), position(random), position(random)), r, vec3(1.0f, 1.0f, 1.0f));
+        
+        mat4 rigid = rigid_inverse(m);
+        CHECK(mat4_near(rigid, inverse(m), 1e-4f));
+        CHECK(mat4_near(rigid * m, identity_mat4(), 1e-5f));
+    }
+}
+
+TEST(vector_helpers) {
+    vec3 a(1.0f, 0.0f, 0.0f);
+    vec3 b(0.0f, 1.0f, 0.0f);
+    vec3 c = cross(a, b);
+    CHECK_NEAR(c.v[2], 1.0f, 0.0);
+    CHECK_NEAR(dot(a, b), 0.0f, 0.0);
+    CHECK_NEAR(length(vec3(3.0f, 4.0f, 0.0f)), 5.0f, 1e-6);
+    CHECK_NEAR(length(normalise(vec3(3.0f, 4.0f, 12.0f))), 1.0f, 1e-6);
+}
+
+int main(void) {
+    return run_tests();
+}